@@ -0,0 +1,379 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include <QuickHull/HullEngine.h>
+#include <QuickHull/ThreadPool.h>
+#include <Utils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+struct Options {
+  std::size_t min_size = 100;
+  std::size_t max_size = 10000000;
+  std::vector<std::size_t> threads;
+  std::vector<std::string> distributions;
+  std::size_t trials = 10;
+  // no new trial is started once the ones of a case took longer than this
+  std::chrono::milliseconds budget = std::chrono::milliseconds{3000};
+  std::size_t max_iterations = std::numeric_limits<std::size_t>::max();
+  bool spatial_sort = false;
+  std::size_t batch_size = 1;
+  std::optional<std::string> output;
+};
+
+void print_usage() {
+  std::cout
+      << "Fast-Quick-Hull-Benchmarks [options]\n"
+         "  --min-size N        smallest cloud, default 100\n"
+         "  --max-size N        biggest cloud, default 10000000\n"
+         "  --threads A,B,...   thread counts to sweep, default 1,2,4,...\n"
+         "                      up to the available cores\n"
+         "  --distributions A,B,...\n"
+         "                      any among cube, sphere, gaussian, clustered,\n"
+         "                      animals. Default all of them\n"
+         "  --trials N          maximum repetitions of each case, default 10\n"
+         "  --budget-ms N       time after which a case stops being\n"
+         "                      repeated, default 3000\n"
+         "  --max-iterations N  see ConvexHullContext, default unbounded\n"
+         "  --spatial-sort 0|1  see ConvexHullContext, default 0\n"
+         "  --batch-size N      see ConvexHullContext, default 1\n"
+         "  --output FILE       where to write the json report, default\n"
+         "                      stdout\n";
+}
+
+std::vector<std::string> split(const std::string &subject) {
+  std::vector<std::string> result;
+  std::istringstream stream(subject);
+  for (std::string slice; std::getline(stream, slice, ',');) {
+    if (!slice.empty()) {
+      result.push_back(slice);
+    }
+  }
+  return result;
+}
+
+Options parse_options(int argc, char **argv) {
+  Options result;
+  for (int k = 1; k < argc; ++k) {
+    const std::string name = argv[k];
+    if (name == "--help") {
+      print_usage();
+      std::exit(EXIT_SUCCESS);
+    }
+    if (k + 1 == argc) {
+      throw std::runtime_error{"Missing value for " + name};
+    }
+    const std::string value = argv[++k];
+    if (name == "--min-size") {
+      result.min_size = std::stoull(value);
+    } else if (name == "--max-size") {
+      result.max_size = std::stoull(value);
+    } else if (name == "--threads") {
+      for (const auto &slice : split(value)) {
+        result.threads.push_back(std::stoull(slice));
+      }
+    } else if (name == "--distributions") {
+      result.distributions = split(value);
+    } else if (name == "--trials") {
+      result.trials = std::max<std::size_t>(1, std::stoull(value));
+    } else if (name == "--budget-ms") {
+      result.budget = std::chrono::milliseconds{std::stoll(value)};
+    } else if (name == "--max-iterations") {
+      result.max_iterations = std::stoull(value);
+    } else if (name == "--spatial-sort") {
+      result.spatial_sort = (std::stoi(value) != 0);
+    } else if (name == "--batch-size") {
+      result.batch_size = std::stoull(value);
+    } else if (name == "--output") {
+      result.output = value;
+    } else {
+      throw std::runtime_error{"Unknown option " + name};
+    }
+  }
+  if (result.threads.empty()) {
+    const std::size_t cores =
+        std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    for (std::size_t threads = 1; threads < cores; threads *= 2) {
+      result.threads.push_back(threads);
+    }
+    result.threads.push_back(cores);
+  }
+  if (result.distributions.empty()) {
+    result.distributions = {"cube", "sphere", "gaussian", "clustered",
+                            "animals"};
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////
+///////////////////// distributions /////////////////////
+/////////////////////////////////////////////////////////
+
+// flat x,y,z buffer
+using Cloud = std::vector<float>;
+
+using Distribution = std::function<Cloud(std::size_t, std::mt19937 &)>;
+
+Cloud uniform_cube(std::size_t size, std::mt19937 &engine) {
+  std::uniform_real_distribution<float> sample(-1.f, 1.f);
+  Cloud result(3 * size);
+  std::generate(result.begin(), result.end(), [&]() { return sample(engine); });
+  return result;
+}
+
+Cloud gaussian(std::size_t size, std::mt19937 &engine) {
+  std::normal_distribution<float> sample(0.f, 1.f);
+  Cloud result(3 * size);
+  std::generate(result.begin(), result.end(), [&]() { return sample(engine); });
+  return result;
+}
+
+// every point lies on the convex hull
+Cloud sphere(std::size_t size, std::mt19937 &engine) {
+  Cloud result = gaussian(size, engine);
+  for (std::size_t k = 0; k < result.size(); k += 3) {
+    float norm = std::sqrt(result[k] * result[k] +
+                           result[k + 1] * result[k + 1] +
+                           result[k + 2] * result[k + 2]);
+    norm = std::max(norm, std::numeric_limits<float>::min());
+    for (std::size_t c = 0; c < 3; ++c) {
+      result[k + c] /= norm;
+    }
+  }
+  return result;
+}
+
+// small gaussian blobs scattered inside a cube
+Cloud clustered(std::size_t size, std::mt19937 &engine) {
+  static constexpr std::size_t CLUSTERS = 16;
+  const Cloud centers = uniform_cube(CLUSTERS, engine);
+  std::uniform_int_distribution<std::size_t> cluster(0, CLUSTERS - 1);
+  std::normal_distribution<float> sample(0.f, 0.05f);
+  Cloud result(3 * size);
+  for (std::size_t k = 0; k < result.size(); k += 3) {
+    const float *center = centers.data() + 3 * cluster(engine);
+    for (std::size_t c = 0; c < 3; ++c) {
+      result[k + c] = center[c] + sample(engine);
+    }
+  }
+  return result;
+}
+
+const std::map<std::string, Distribution> DISTRIBUTIONS = {
+    {"cube", uniform_cube},
+    {"sphere", sphere},
+    {"gaussian", gaussian},
+    {"clustered", clustered},
+};
+
+const std::vector<std::string> ANIMALS = {"Dolphin", "Eagle", "Giraffe",
+                                          "Hyppo", "Snake"};
+
+/////////////////////////////////////////////////////////
+//////////////////////// metrics ////////////////////////
+/////////////////////////////////////////////////////////
+
+// Linux allows to reset the peak resident set size, so that each case can be
+// measured on its own. Elsewhere the peak of the whole process is reported.
+void reset_peak_memory() {
+#ifdef __linux__
+  std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+std::optional<std::size_t> peak_memory_kb() {
+#ifdef __linux__
+  std::ifstream status("/proc/self/status");
+  for (std::string line; std::getline(status, line);) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::stoull(line.substr(6));
+    }
+  }
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+  }
+#endif
+  return std::nullopt;
+}
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+// nearest rank percentile of sorted samples
+double percentile(const std::vector<double> &samples, double rank) {
+  std::size_t pos = static_cast<std::size_t>(
+      std::ceil(rank / 100.0 * static_cast<double>(samples.size())));
+  pos = std::clamp<std::size_t>(pos, 1, samples.size());
+  return samples[pos - 1];
+}
+
+struct Case {
+  std::string distribution;
+  std::size_t size;
+  std::size_t threads;
+};
+
+struct Result {
+  std::vector<double> durations_ms;
+  std::size_t facets = 0;
+  std::optional<std::size_t> peak_memory_kb;
+};
+
+Result run(const qh::PointsView &view, const qh::ConvexHullContext &context,
+           const Options &options) {
+  reset_peak_memory();
+  Result result;
+  qh::HullEngine engine(context);
+  Milliseconds elapsed{0};
+  while (result.durations_ms.size() < options.trials &&
+         elapsed < options.budget) {
+    auto tic = std::chrono::steady_clock::now();
+    result.facets = engine.compute(view).size();
+    Milliseconds duration = std::chrono::steady_clock::now() - tic;
+    result.durations_ms.push_back(duration.count());
+    elapsed += duration;
+  }
+  std::sort(result.durations_ms.begin(), result.durations_ms.end());
+  result.peak_memory_kb = peak_memory_kb();
+  return result;
+}
+
+void to_json(std::ostream &stream, const Case &subject, const Result &result) {
+  const auto &samples = result.durations_ms;
+  double mean = 0;
+  for (const auto sample : samples) {
+    mean += sample / static_cast<double>(samples.size());
+  }
+  const double median = percentile(samples, 50);
+  stream << "{\"distribution\":\"" << subject.distribution
+         << "\",\"size\":" << subject.size
+         << ",\"threads\":" << subject.threads
+         << ",\"trials\":" << samples.size() << ",\"facets\":" << result.facets
+         << ",\"time_ms\":{\"min\":" << samples.front()
+         << ",\"p50\":" << median << ",\"p90\":" << percentile(samples, 90)
+         << ",\"p99\":" << percentile(samples, 99)
+         << ",\"max\":" << samples.back() << ",\"mean\":" << mean << '}'
+         << ",\"points_per_second\":"
+         << static_cast<double>(subject.size) / (median * 1e-3)
+         << ",\"peak_rss_kb\":";
+  if (result.peak_memory_kb) {
+    stream << *result.peak_memory_kb;
+  } else {
+    stream << "null";
+  }
+  stream << '}';
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  try {
+    options = parse_options(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    print_usage();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::pair<std::string, Cloud>> clouds;
+  for (const auto &name : options.distributions) {
+    if (name == "animals") {
+      for (const auto &animal : ANIMALS) {
+        clouds.emplace_back(animal, importStl(getAnimalStlPath(animal)));
+      }
+      continue;
+    }
+    auto it = DISTRIBUTIONS.find(name);
+    if (it == DISTRIBUTIONS.end()) {
+      std::cerr << "Unknown distribution " << name << std::endl;
+      return EXIT_FAILURE;
+    }
+    // sizes are swept later, generating the biggest cloud is enough: each
+    // smaller one is a prefix of it
+    std::mt19937 engine(0);
+    clouds.emplace_back(name, it->second(options.max_size, engine));
+  }
+
+  std::ofstream file;
+  if (options.output) {
+    file.open(*options.output);
+    if (!file.is_open()) {
+      std::cerr << *options.output << " is an invalid filename" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream &report = options.output ? file : std::cout;
+  report << "{\"hardware_concurrency\":" << std::thread::hardware_concurrency()
+         << ",\"results\":[\n";
+
+  bool first = true;
+  for (const auto threads : options.threads) {
+    std::optional<qh::ThreadPool> pool;
+    qh::ConvexHullContext context;
+    context.max_iterations = options.max_iterations;
+    context.spatial_sort = options.spatial_sort;
+    context.batch_size = options.batch_size;
+    context.thread_pool_size = std::nullopt;
+    if (1 < threads) {
+      pool.emplace(threads);
+      context.thread_pool = &pool.value();
+    }
+
+    for (const auto &[name, cloud] : clouds) {
+      const std::size_t points = cloud.size() / 3;
+      std::vector<std::size_t> sizes;
+      if (DISTRIBUTIONS.find(name) == DISTRIBUTIONS.end()) {
+        sizes.push_back(points);
+      } else {
+        for (std::size_t size = options.min_size; size <= points; size *= 10) {
+          sizes.push_back(size);
+        }
+        if (sizes.empty() || sizes.back() != points) {
+          sizes.push_back(points);
+        }
+      }
+      for (const auto size : sizes) {
+        const Case subject{name, size, threads};
+        std::cerr << name << " size " << size << " threads " << threads
+                  << std::endl;
+        const auto result =
+            run(qh::PointsView{cloud.data(), size}, context, options);
+        report << (first ? "" : ",\n");
+        to_json(report, subject, result);
+        report.flush();
+        first = false;
+      }
+    }
+  }
+  report << "\n]}" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,372 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <QuickHull/Error.h>
+#include <QuickHull/FastQuickHull.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+static_assert(sizeof(qh::FacetIncidences) == 3 * sizeof(std::size_t));
+static_assert(sizeof(hull::Coordinate) == 3 * sizeof(float));
+
+// Keeps alive the memory exposed by an Array, whatever the type of the
+// vector that allocated it.
+struct Storage {
+  virtual ~Storage() = default;
+};
+
+template <typename T> struct VectorStorage : Storage {
+  explicit VectorStorage(std::vector<T> &&values)
+      : values(std::move(values)) {}
+
+  std::vector<T> values;
+};
+
+// A rows x 3 matrix exposed through the buffer protocol, wrapping a vector
+// returned by the library.
+struct Array {
+  PyObject_HEAD Storage *storage;
+  char *data;
+  Py_ssize_t itemsize;
+  const char *format;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+};
+
+PyTypeObject *array_type = nullptr;
+
+void array_dealloc(PyObject *self) {
+  auto *array = reinterpret_cast<Array *>(self);
+  delete array->storage;
+  PyTypeObject *type = Py_TYPE(self);
+  type->tp_free(self);
+  Py_DECREF(type);
+}
+
+int array_get_buffer(PyObject *self, Py_buffer *view, int flags) {
+  auto *array = reinterpret_cast<Array *>(self);
+  // any non empty pointer is fine for the empty arrays
+  static char empty = 0;
+  view->buf = (array->data == nullptr) ? &empty : array->data;
+  view->obj = self;
+  Py_INCREF(self);
+  view->len = array->shape[0] * array->strides[0];
+  view->readonly = 0;
+  view->itemsize = array->itemsize;
+  view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT)
+                     ? const_cast<char *>(array->format)
+                     : nullptr;
+  // the matrix is C contiguous, the shape and the strides can be omitted
+  view->ndim = 2;
+  view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? array->shape : nullptr;
+  view->strides =
+      ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? array->strides : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+PyType_Slot array_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void *>(array_dealloc)},
+    {Py_bf_getbuffer, reinterpret_cast<void *>(array_get_buffer)},
+    {Py_tp_doc, const_cast<char *>(
+                    "Matrix allocated by the library, exposed through the "
+                    "buffer protocol.")},
+    {0, nullptr}};
+
+PyType_Spec array_spec = {"fast_quick_hull.Array", sizeof(Array), 0,
+                          Py_TPFLAGS_DEFAULT, array_slots};
+
+template <typename Scalar, typename T>
+PyObject *make_array(std::vector<T> &&values, const char *format) {
+  auto *array = PyObject_New(Array, array_type);
+  if (array == nullptr) {
+    return nullptr;
+  }
+  auto *storage = new VectorStorage<T>{std::move(values)};
+  array->storage = storage;
+  array->data = reinterpret_cast<char *>(storage->values.data());
+  array->itemsize = sizeof(Scalar);
+  array->format = format;
+  array->shape[0] = static_cast<Py_ssize_t>(storage->values.size());
+  array->shape[1] = 3;
+  array->strides[0] = sizeof(T);
+  array->strides[1] = sizeof(Scalar);
+  return reinterpret_cast<PyObject *>(array);
+}
+
+// Wraps the passed Array into a numpy array sharing its memory, or a
+// memoryview when numpy is not available. The reference to the Array is
+// stolen.
+PyObject *to_numpy(PyObject *array) {
+  if (array == nullptr) {
+    return nullptr;
+  }
+  PyObject *numpy = PyImport_ImportModule("numpy");
+  PyObject *result = nullptr;
+  if (numpy == nullptr) {
+    PyErr_Clear();
+    result = PyMemoryView_FromObject(array);
+  } else {
+    result = PyObject_CallMethod(numpy, "asarray", "O", array);
+    Py_DECREF(numpy);
+  }
+  Py_DECREF(array);
+  return result;
+}
+
+bool is_native(char byte_order) {
+  const std::uint16_t probe = 1;
+  const bool little_endian = *reinterpret_cast<const char *>(&probe) == 1;
+  switch (byte_order) {
+  case '@':
+  case '=':
+    return true;
+  case '<':
+    return little_endian;
+  case '>':
+  case '!':
+    return !little_endian;
+  }
+  return false;
+}
+
+// 'f', 'd' or 0 when the buffer doesn't store native floats or doubles
+char scalar_type(const Py_buffer &buffer) {
+  const char *format = (buffer.format == nullptr) ? "B" : buffer.format;
+  if ((format[0] != 0) && (format[1] != 0) && is_native(format[0])) {
+    ++format;
+  }
+  if ((std::strcmp(format, "f") == 0) && (buffer.itemsize == sizeof(float))) {
+    return 'f';
+  }
+  if ((std::strcmp(format, "d") == 0) &&
+      (buffer.itemsize == sizeof(double))) {
+    return 'd';
+  }
+  return 0;
+}
+
+template <typename Scalar>
+PyObject *compute(Py_buffer &buffer, const qh::ConvexHullContext &context) {
+  qh::BasicPointsView<Scalar> points{static_cast<const Scalar *>(buffer.buf),
+                                     static_cast<std::size_t>(buffer.shape[0])};
+  // the coordinates of each point should be contiguous, the points can be
+  // interleaved with anything else. Any other layout is copied.
+  std::vector<Scalar> copy;
+  if ((buffer.strides[1] == buffer.itemsize) &&
+      (3 * buffer.itemsize <= buffer.strides[0]) &&
+      (buffer.strides[0] % buffer.itemsize == 0)) {
+    points.stride = static_cast<std::size_t>(buffer.strides[0] /
+                                             buffer.itemsize);
+  } else {
+    copy.resize(3 * points.size);
+    if (PyBuffer_ToContiguous(copy.data(), &buffer,
+                              copy.size() * sizeof(Scalar), 'C') != 0) {
+      return nullptr;
+    }
+    points.data = copy.data();
+  }
+
+  std::vector<qh::FacetIncidences> incidences;
+  std::vector<hull::Coordinate> normals;
+  PyObject *error_type = nullptr;
+  std::string error;
+  Py_BEGIN_ALLOW_THREADS;
+  try {
+    incidences = qh::convex_hull(points, normals, context);
+  } catch (const qh::Error &e) {
+    error_type = PyExc_ValueError;
+    error = e.what();
+  } catch (const std::bad_alloc &) {
+    error_type = PyExc_MemoryError;
+  } catch (const std::exception &e) {
+    error_type = PyExc_RuntimeError;
+    error = e.what();
+  }
+  Py_END_ALLOW_THREADS;
+  if (error_type != nullptr) {
+    PyErr_SetString(error_type, error.c_str());
+    return nullptr;
+  }
+
+  const char *index_format =
+      (sizeof(std::size_t) == sizeof(unsigned long long)) ? "Q" : "I";
+  PyObject *facets =
+      to_numpy(make_array<std::size_t>(std::move(incidences), index_format));
+  if (facets == nullptr) {
+    return nullptr;
+  }
+  PyObject *normals_array =
+      to_numpy(make_array<float>(std::move(normals), "f"));
+  if (normals_array == nullptr) {
+    Py_DECREF(facets);
+    return nullptr;
+  }
+  return Py_BuildValue("(NN)", facets, normals_array);
+}
+
+bool parse_interior_culling(const char *name, qh::InteriorCulling &result) {
+  static const std::pair<const char *, qh::InteriorCulling> VALUES[] = {
+      {"none", qh::InteriorCulling::NONE},
+      {"dop6", qh::InteriorCulling::DOP_6},
+      {"dop14", qh::InteriorCulling::DOP_14},
+      {"dop26", qh::InteriorCulling::DOP_26}};
+  for (const auto &[value_name, value] : VALUES) {
+    if (std::strcmp(name, value_name) == 0) {
+      result = value;
+      return true;
+    }
+  }
+  PyErr_Format(PyExc_ValueError,
+               "interior_culling should be any among none, dop6, dop14, "
+               "dop26, not %s",
+               name);
+  return false;
+}
+
+bool parse_parallel_mode(const char *name, qh::ParallelMode &result) {
+  if (std::strcmp(name, "per_iteration") == 0) {
+    result = qh::ParallelMode::PER_ITERATION;
+    return true;
+  }
+  if (std::strcmp(name, "divide_and_conquer") == 0) {
+    result = qh::ParallelMode::DIVIDE_AND_CONQUER;
+    return true;
+  }
+  PyErr_Format(PyExc_ValueError,
+               "parallel_mode should be per_iteration or "
+               "divide_and_conquer, not %s",
+               name);
+  return false;
+}
+
+PyObject *convex_hull(PyObject *, PyObject *args, PyObject *kwargs) {
+  static const char *KEYWORDS[] = {"points",
+                                   "max_iterations",
+                                   "thread_pool_size",
+                                   "interior_culling",
+                                   "parallel_mode",
+                                   "spatial_sort",
+                                   nullptr};
+  PyObject *points = nullptr;
+  qh::ConvexHullContext context;
+  Py_ssize_t max_iterations = static_cast<Py_ssize_t>(context.max_iterations);
+  PyObject *thread_pool_size = Py_None;
+  const char *interior_culling = "none";
+  const char *parallel_mode = "per_iteration";
+  int spatial_sort = 0;
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, "O|$nOssp:convex_hull", const_cast<char **>(KEYWORDS),
+          &points, &max_iterations, &thread_pool_size, &interior_culling,
+          &parallel_mode, &spatial_sort)) {
+    return nullptr;
+  }
+  if (max_iterations < 0) {
+    PyErr_SetString(PyExc_ValueError, "max_iterations should be positive");
+    return nullptr;
+  }
+  context.max_iterations = static_cast<std::size_t>(max_iterations);
+  if (thread_pool_size != Py_None) {
+    const Py_ssize_t size = PyLong_AsSsize_t(thread_pool_size);
+    if (PyErr_Occurred() != nullptr) {
+      return nullptr;
+    }
+    if (size < 0) {
+      PyErr_SetString(PyExc_ValueError,
+                      "thread_pool_size should be positive");
+      return nullptr;
+    }
+    context.thread_pool_size = static_cast<std::size_t>(size);
+  }
+  if (!parse_interior_culling(interior_culling, context.interior_culling) ||
+      !parse_parallel_mode(parallel_mode, context.parallel_mode)) {
+    return nullptr;
+  }
+  context.spatial_sort = (spatial_sort != 0);
+
+  Py_buffer buffer;
+  if (PyObject_GetBuffer(points, &buffer, PyBUF_STRIDES | PyBUF_FORMAT) !=
+      0) {
+    return nullptr;
+  }
+  PyObject *result = nullptr;
+  const char type = scalar_type(buffer);
+  if ((buffer.ndim != 2) || (buffer.shape[1] != 3)) {
+    PyErr_SetString(PyExc_ValueError, "points should be a N x 3 matrix");
+  } else if (type == 'f') {
+    result = compute<float>(buffer, context);
+  } else if (type == 'd') {
+    result = compute<double>(buffer, context);
+  } else {
+    PyErr_SetString(PyExc_TypeError,
+                    "points should store float32 or float64 values");
+  }
+  PyBuffer_Release(&buffer);
+  return result;
+}
+
+PyMethodDef METHODS[] = {
+    // the keywords taking signature is cast through a generic function
+    // pointer, as CPython itself does, to not trigger -Wcast-function-type
+    {"convex_hull",
+     reinterpret_cast<PyCFunction>(
+         reinterpret_cast<void (*)(void)>(convex_hull)),
+     METH_VARARGS | METH_KEYWORDS,
+     "convex_hull(points, *, max_iterations=1000, thread_pool_size=None,\n"
+     "            interior_culling='none', parallel_mode='per_iteration',\n"
+     "            spatial_sort=False)\n"
+     "--\n\n"
+     "Computes the convex hull of points, a N x 3 matrix of float32 or\n"
+     "float64 values exposing the buffer protocol, as a numpy array. The\n"
+     "points are read without copying them, as long as the coordinates of\n"
+     "each point are contiguous. The GIL is released during the\n"
+     "computation.\n"
+     "Returns the F x 3 matrices of the incidences (the rows of points\n"
+     "making each facet) and of the outgoing normals, as numpy arrays\n"
+     "owning the memory allocated by the library (memoryviews when numpy\n"
+     "is not available).\n"
+     "Raises ValueError when the hull can't be computed, as for a cloud\n"
+     "with null volume."},
+    {nullptr, nullptr, 0, nullptr}};
+
+PyModuleDef MODULE = {PyModuleDef_HEAD_INIT,
+                      "fast_quick_hull",
+                      "Python bindings of the Fast-Quick-Hull library.",
+                      -1,
+                      METHODS,
+                      nullptr,
+                      nullptr,
+                      nullptr,
+                      nullptr};
+} // namespace
+
+PyMODINIT_FUNC PyInit_fast_quick_hull() {
+  PyObject *module = PyModule_Create(&MODULE);
+  if (module == nullptr) {
+    return nullptr;
+  }
+  array_type = reinterpret_cast<PyTypeObject *>(PyType_FromSpec(&array_spec));
+  if ((array_type == nullptr) ||
+      (PyModule_AddObject(module, "Array",
+                          reinterpret_cast<PyObject *>(array_type)) != 0)) {
+    Py_XDECREF(array_type);
+    Py_DECREF(module);
+    return nullptr;
+  }
+  // the module keeps a reference as well
+  Py_INCREF(array_type);
+  return module;
+}
@@ -0,0 +1,96 @@
+# -*- coding: utf-8 -*-
+"""
+* Author:    Andrea Casalino
+* Created:   03.12.2019
+*
+* report any bug to andrecasa91@gmail.com.
+"""
+
+import threading
+import unittest
+
+import numpy as np
+
+import fast_quick_hull as fqh
+
+def is_convex_hull(points, facets, normals, tolerance=1e-3):
+    if facets.shape[0] != normals.shape[0]:
+        return False
+    for facet, normal in zip(facets, normals):
+        distances = (points - points[facet[0]]) @ normal
+        if tolerance < distances.max():
+            return False
+    return True
+
+class ConvexHullTest(unittest.TestCase):
+    def setUp(self):
+        self.points = np.random.default_rng(0).uniform(
+            -1, 1, (2000, 3)).astype(np.float32)
+
+    def check(self, points, **options):
+        facets, normals = fqh.convex_hull(points, **options)
+        self.assertIsInstance(facets, np.ndarray)
+        self.assertEqual(facets.shape[1], 3)
+        self.assertEqual(normals.shape[1], 3)
+        self.assertEqual(normals.dtype, np.float32)
+        self.assertTrue(is_convex_hull(np.asarray(points, dtype=np.float64),
+                                       facets, normals))
+        return facets, normals
+
+    def test_float(self):
+        self.check(self.points)
+
+    def test_double(self):
+        self.check(self.points.astype(np.float64))
+
+    def test_interleaved(self):
+        # positions and normals of a vertex buffer
+        vertices = np.hstack([self.points, np.zeros_like(self.points)])
+        expected, _ = self.check(self.points)
+        facets, _ = self.check(vertices[:, :3])
+        self.assertTrue(np.array_equal(expected, facets))
+
+    def test_copied_layouts(self):
+        for points in [np.asfortranarray(self.points), self.points[::-1]]:
+            self.check(points)
+
+    def test_options(self):
+        self.check(self.points, thread_pool_size=2,
+                   parallel_mode='divide_and_conquer')
+        self.check(self.points, interior_culling='dop14', spatial_sort=True)
+
+    def test_owned_memory(self):
+        def owner(array):
+            # numpy wraps the exported buffer into a memoryview
+            return array.base.obj
+        facets, normals = fqh.convex_hull(self.points)
+        self.assertIsInstance(owner(facets), fqh.Array)
+        self.assertIsInstance(owner(normals), fqh.Array)
+        facets[0, 0] = 0
+
+    def test_errors(self):
+        with self.assertRaises(ValueError):
+            fqh.convex_hull(self.points[:, :2])
+        with self.assertRaises(TypeError):
+            fqh.convex_hull(self.points.astype(np.int32))
+        with self.assertRaises(ValueError):
+            fqh.convex_hull(np.zeros((10, 3), dtype=np.float32))
+        with self.assertRaises(ValueError):
+            fqh.convex_hull(self.points, interior_culling='dop8')
+
+    def test_concurrent_calls(self):
+        # the GIL is released, the computations overlap
+        results = [None] * 4
+        def compute(index):
+            results[index] = fqh.convex_hull(self.points)[0]
+        threads = [threading.Thread(target=compute, args=(k,))
+                   for k in range(len(results))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for result in results:
+            self.assertTrue(np.array_equal(results[0], result))
+
+if __name__ == '__main__':
+    unittest.main()
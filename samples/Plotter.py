@@ -13,6 +13,8 @@ import matplotlib.pyplot as plt
 from matplotlib.widgets import CheckButtons
 from optparse import OptionParser
 import json
+import os
+import struct
 
 # https://pypi.org/project/numpy-stl/
 class Stl:
@@ -92,10 +94,82 @@ class Hull:
         for facet in self.faces:
             facet.remove()
 
-def importConvexHull(filename, ax):
+def triplets(values):
+    return [values[k:k+3] for k in range(0, len(values), 3)]
+
+# files written by writeCompact (utils/HullFiles.h)
+def readCompact(filename):
+    with open(filename, 'rb') as stream:
+        content = stream.read()
+    tag, version, flags, points, facets = struct.unpack_from('<8sIIQQ', content)
+    if tag != b'QHULLBIN' or version != 1:
+        raise ValueError(filename + ' is not a compact convex hull file')
+    offset = 32
+    cloud = struct.unpack_from('<%df' % (3 * points), content, offset)
+    offset += 12 * points
+    index = struct.unpack_from('<%dI' % (3 * facets), content, offset)
+    offset += 12 * facets
+    normals = []
+    if flags & 1:
+        normals = struct.unpack_from('<%df' % (3 * facets), content, offset)
+    return {'Cloud':triplets(cloud), 'Index':triplets(index), 'Normals':triplets(normals)}
+
+# files written by writePly (utils/HullFiles.h)
+def readPly(filename):
+    with open(filename, 'rb') as stream:
+        content = stream.read()
+    end = content.index(b'end_header\n') + len(b'end_header\n')
+    header = content[:end].decode('ascii').split('\n')
+    if 'format binary_little_endian 1.0' not in header:
+        raise ValueError(filename + ' is not a binary little endian PLY file')
+    points = facets = 0
+    for line in header:
+        if line.startswith('element vertex '):
+            points = int(line.split()[2])
+        if line.startswith('element face '):
+            facets = int(line.split()[2])
+    cloud = struct.unpack_from('<%df' % (3 * points), content, end)
+    face = '<B3I3f' if 'property float nx' in header else '<B3I'
+    offset = end + 12 * points
+    index = []
+    normals = []
+    for values in struct.iter_unpack(face, content[offset:offset + facets * struct.calcsize(face)]):
+        index.append(values[1:4])
+        if len(values) > 4:
+            normals.append(values[4:])
+    return {'Cloud':triplets(cloud), 'Index':index, 'Normals':normals}
+
+# files written by writeObj (utils/HullFiles.h), made of triangles
+def readObj(filename):
+    cloud = []
+    index = []
+    normals = []
+    with open(filename) as stream:
+        for line in stream:
+            tokens = line.split()
+            if not tokens:
+                continue
+            if tokens[0] == 'v':
+                cloud.append([float(value) for value in tokens[1:4]])
+            elif tokens[0] == 'vn':
+                normals.append([float(value) for value in tokens[1:4]])
+            elif tokens[0] == 'f':
+                index.append([int(vertex.split('/')[0]) - 1 for vertex in tokens[1:4]])
+    return {'Cloud':cloud, 'Index':index, 'Normals':normals}
+
+def readJson(filename):
     with open(filename) as stream:
-        data = json.load(stream)  
-        return (PointCloud(data, ax) , Hull(data, ax))
+        return json.load(stream)
+
+def importConvexHull(filename, ax):
+    readers = {
+        '.json':readJson,
+        '.qhb':readCompact,
+        '.ply':readPly,
+        '.obj':readObj
+    }
+    data = readers[os.path.splitext(filename)[1].lower()](filename)
+    return (PointCloud(data, ax) , Hull(data, ax))
 
 class Figure:
     def __init__(self):
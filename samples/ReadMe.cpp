@@ -48,5 +48,17 @@ int main() {
                                  normals, context);
   }
 
+  {
+    // the pool should outlive all the convex_hull calls using it
+    qh::ThreadPool pool(4, true); // 4 threads, pinned to the cores
+    qh::ConvexHullContext context;
+    context.thread_pool = &pool;
+    // the work of an iteration is split among the threads only when involving
+    // enough vertices or facets, otherwise it is done by the calling thread
+    context.parallel_threshold = 2048;
+    incidences = qh::convex_hull(points.begin(), points.end(),
+                                 convert_function, context);
+  }
+
   return EXIT_SUCCESS;
 }
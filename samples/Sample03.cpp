@@ -0,0 +1,49 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include <QuickHull/Batch.h>
+#include <Utils.h>
+
+#include <iostream>
+
+int main() {
+  // many small clouds, like the collision shapes of the parts of a model
+  const std::size_t clouds_number = 5000;
+  std::vector<std::vector<hull::Coordinate>> clouds;
+  clouds.reserve(clouds_number);
+  for (std::size_t k = 0; k < clouds_number; ++k) {
+    auto cloud = sampleCloud(20 + (k * 37) % 1980);
+    auto &points = clouds.emplace_back();
+    points.reserve(cloud.size());
+    for (const auto &vertex : cloud) {
+      points.push_back(to_hull_coordinate(vertex));
+    }
+  }
+
+  // the same result can be reused for many batches
+  qh::BatchResult result;
+  for (const std::optional<std::size_t> thread_pool_size :
+       {std::optional<std::size_t>{}, std::optional<std::size_t>{0}}) {
+    qh::ConvexHullContext context;
+    // the clouds are distributed among all the cores, when specifying 0
+    context.thread_pool_size = thread_pool_size;
+    qh::convex_hull_batch(clouds, result, context);
+
+    std::cout << (thread_pool_size.has_value() ? "all cores" : "serial   ")
+              << " computed " << result.size() << " convex hulls: "
+              << result.hullsPerSecond() << " hulls/second" << std::endl;
+  }
+
+  // the facets of the k-th convex hull are stored in [offsets[k],
+  // offsets[k+1]) of the flat buffers
+  const std::size_t k = 3;
+  std::cout << "convex hull of cloud " << k << " has "
+            << result.offsets[k + 1] - result.offsets[k] << " facets"
+            << std::endl;
+
+  return EXIT_SUCCESS;
+}
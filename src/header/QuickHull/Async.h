@@ -0,0 +1,66 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+namespace qh {
+/** @brief Stops the computations whose ConvexHullContext::cancellation points
+ * to it, from any thread. Each computation checks it once per iteration and
+ * returns the hull built so far.
+ */
+class CancellationToken {
+public:
+  CancellationToken() = default;
+
+  CancellationToken(const CancellationToken &) = delete;
+  CancellationToken &operator=(const CancellationToken &) = delete;
+
+  void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+  bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+  // allows to reuse the token for the next computations
+  void reset() { cancelled.store(false, std::memory_order_relaxed); }
+
+private:
+  std::atomic<bool> cancelled{false};
+};
+
+struct ConvexHullResult {
+  std::vector<FacetIncidences> incidences;
+  std::vector<hull::Coordinate> normals;
+};
+
+/** @brief Computes the convex hull of points in a new thread, with the
+ * fields of cntx.
+ * The context is copied: the pool, the stats, the mass properties, the
+ * tracer and the cancellation token it points to should outlive the
+ * computation.
+ * An Error thrown by the computation is rethrown by the get of the returned
+ * future.
+ */
+std::future<ConvexHullResult>
+convex_hull_async(std::vector<hull::Coordinate> points,
+                  const ConvexHullContext &cntx = ConvexHullContext{});
+
+/** @brief Same as above, reading the points from an external buffer, which
+ * should outlive the computation.
+ */
+std::future<ConvexHullResult>
+convex_hull_async(const PointsView &points,
+                  const ConvexHullContext &cntx = ConvexHullContext{});
+
+std::future<ConvexHullResult>
+convex_hull_async(const PointsViewD &points,
+                  const ConvexHullContext &cntx = ConvexHullContext{});
+} // namespace qh
@@ -0,0 +1,89 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qh {
+/** @brief The convex hulls of a batch of clouds, stored into flat buffers.
+ * The facets of the k-th hull are the ones in [offsets[k], offsets[k+1]).
+ * The same BatchResult can be passed to many convex_hull_batch calls, reusing
+ * the already allocated buffers.
+ */
+struct BatchResult {
+  BatchResult();
+  ~BatchResult();
+
+  BatchResult(const BatchResult &) = delete;
+  BatchResult &operator=(const BatchResult &) = delete;
+  BatchResult(BatchResult &&);
+  BatchResult &operator=(BatchResult &&);
+
+  // the positions refer to the cloud the facet belongs to
+  std::vector<FacetIncidences> incidences;
+  std::vector<hull::Coordinate> normals;
+  std::vector<std::size_t> offsets;
+
+  std::size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+  // errors[k] is empty when the k-th hull was computed, otherwise it is the
+  // message of the qh::Error raised by it, as for a cloud with null volume.
+  // The facets range of a failed hull is empty.
+  std::vector<std::string> errors;
+  bool failed(std::size_t k) const { return !errors[k].empty(); }
+
+  // When true, mass_properties[k] is filled with the mass properties of the
+  // k-th hull, otherwise mass_properties is left empty. The ones of a failed
+  // hull are all zeros.
+  bool compute_mass_properties = false;
+  std::vector<MassProperties> mass_properties;
+
+  // the time spent by the last convex_hull_batch call
+  std::chrono::nanoseconds elapsed{0};
+  double hullsPerSecond() const;
+
+  // internal buffers, storing the hulls before flattening them
+  struct Workspace;
+
+private:
+  friend void convex_hull_batch(const std::vector<hull::Coordinate> *,
+                                std::size_t, BatchResult &,
+                                const ConvexHullContext &);
+  friend void convex_hull_batch(const PointsView *, std::size_t,
+                                BatchResult &, const ConvexHullContext &);
+
+  std::unique_ptr<Workspace> workspace;
+};
+
+/** @brief Computes the convex hulls of many independent clouds, each one
+ * processed by a single thread.
+ * The clouds are distributed among the threads of the pool described by cntx
+ * (ConvexHullContext::thread_pool or ConvexHullContext::thread_pool_size),
+ * each thread taking the next cloud as soon as it gets free. The remaining
+ * fields of cntx apply to the computation of each single hull.
+ * A cloud whose hull can't be computed doesn't stop the others: see
+ * BatchResult::errors.
+ * The pool should not be the one running the caller.
+ */
+void convex_hull_batch(const std::vector<hull::Coordinate> *clouds,
+                       std::size_t clouds_size, BatchResult &result,
+                       const ConvexHullContext &cntx = ConvexHullContext{});
+
+void convex_hull_batch(const PointsView *clouds, std::size_t clouds_size,
+                       BatchResult &result,
+                       const ConvexHullContext &cntx = ConvexHullContext{});
+
+void convex_hull_batch(const std::vector<std::vector<hull::Coordinate>> &clouds,
+                       BatchResult &result,
+                       const ConvexHullContext &cntx = ConvexHullContext{});
+} // namespace qh
@@ -8,18 +8,221 @@
 #pragma once
 
 #include <Hull/Coordinate.h>
+#include <QuickHull/ThreadPool.h>
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <functional>
 #include <optional>
 #include <vector>
 
 namespace qh {
+class CancellationToken;
+class Tracer;
+
 using FacetIncidences = std::array<std::size_t, 3>;
 
+/** @brief View over an externally owned buffer of floats or doubles, storing
+ * the coordinates of a cloud of points. The buffer is read as it is, without
+ * copying it into a std::vector<hull::Coordinate>.
+ * The coordinates of the k-th point are data[k * stride + {0, 1, 2}], which
+ * allows to directly read vertex buffers interleaving positions with other
+ * attributes (normals, uv, etc...).
+ * The convex hull of a view of doubles is computed in double precision, with
+ * a tolerance scaled to the size of the cloud.
+ */
+template <typename Scalar> struct BasicPointsView {
+  const Scalar *data;
+  // the number of points
+  std::size_t size;
+  // number of scalars between the beginning of two consecutive points
+  std::size_t stride = 3;
+};
+
+using PointsView = BasicPointsView<float>;
+using PointsViewD = BasicPointsView<double>;
+
+PointsView make_view(const std::vector<hull::Coordinate> &points);
+
+/** @brief The directions used to discard the points of the cloud which are
+ * surely not part of the convex hull, before starting the Quick Hull
+ * iterations. The farthest points along each direction (and its opposite)
+ * are the vertices of a polytope, surely contained in the convex hull: all
+ * the points strictly inside it are discarded.
+ */
+enum class InteriorCulling {
+  NONE,
+  // the 3 axes: 6 extreme points
+  DOP_6,
+  // the axes, plus the 4 diagonals of the cube: 14 extreme points
+  DOP_14,
+  // the above ones, plus the 6 diagonals of the faces of the cube: 26
+  // extreme points
+  DOP_26
+};
+
+/** @brief How the threads of the pool are exploited by a single convex hull
+ * computation.
+ */
+enum class ParallelMode {
+  // the work of each iteration (distances update) is split among the threads
+  PER_ITERATION,
+  // the cloud is split in chunks, whose convex hulls are computed in parallel
+  // by a single thread each. The final hull is then computed from the
+  // vertices of the chunks hulls only.
+  DIVIDE_AND_CONQUER
+};
+
+/** @brief Trades the accuracy of the convex hull for speed, stopping the
+ * Quick Hull iterations as soon as the hull is close enough to the cloud or
+ * is made of enough vertices. The returned hull is always made of points of
+ * the cloud, possibly leaving some of them outside.
+ */
+struct Approximation {
+  // the iterations stop when the farthest point left outside the hull is
+  // closer than this fraction of the greatest extent of the bounding box of
+  // the cloud to the facet it is in front of. Its distance from the hull,
+  // reported by ConvexHullStats::approximation_error, can be greater.
+  float relative_tolerance = 0.01f;
+  // the iterations stop before the hull exceeds this number of vertices
+  // (facets). 0 means no budget.
+  std::size_t max_vertices = 0;
+  std::size_t max_facets = 0;
+  // When not 0, only the farthest points of the cloud along this number of
+  // directions, evenly spread over the sphere, are considered (epsilon-kernel
+  // coreset). The iterations are then bounded by the number of directions,
+  // no matter how big the cloud is. Replaces the interior culling.
+  std::size_t coreset_directions = 0;
+};
+
+/** @brief Counters describing a convex hull computation, filled when passed
+ * through ConvexHullContext::stats.
+ */
+struct ConvexHullStats {
+  // the vertices added to the hull after the initial tethraedron
+  std::size_t iterations = 0;
+  // the times the outside sets were updated after adding some vertices: the
+  // same as iterations, unless ConvexHullContext::batch_size is greater than 1
+  std::size_t batches = 0;
+  // true when the computation was stopped with vertices still outside the
+  // hull
+  bool max_iterations_reached = false;
+  // point to plane distances evaluated to assign the vertices to the facets
+  // in front of them and to find the farthest one of each facet
+  std::size_t distance_evaluations = 0;
+  std::size_t facets_added = 0;
+  std::size_t facets_changed = 0;
+  std::size_t facets_removed = 0;
+  // Hausdorff distance between the cloud and the hull,
+  // computed when the computation was stopped with vertices still outside
+  // the hull, or ran on a coreset (in which case all the points of the cloud
+  // are compared against the hull). 0 otherwise. The points closer to the
+  // hull than the geometric tolerance of the computation are not accounted.
+  // Not computed for an interrupted computation.
+  double approximation_error = 0;
+  // the maximum number of vertices that were outside the hull under
+  // construction at the same time, i.e. in the conflict list of some facet
+  std::size_t peak_open_set_size = 0;
+  // true when the computation was stopped by ConvexHullContext::cancellation
+  // or ConvexHullContext::deadline, with vertices still outside the hull
+  bool interrupted = false;
+  // bounding box, interior culling and initial tethraedron
+  std::chrono::nanoseconds setup_time{0};
+  // spent updating the facets of the hull
+  std::chrono::nanoseconds hull_update_time{0};
+  // spent updating the conflict lists after each hull update
+  std::chrono::nanoseconds distances_update_time{0};
+};
+
+/** @brief Mass properties of the solid delimited by a convex hull, assuming
+ * a unit density: multiply volume and inertia by the density of the body.
+ * Computed when passed through ConvexHullContext::mass_properties.
+ */
+struct MassProperties {
+  double volume = 0;
+  double surface_area = 0;
+  std::array<double, 3> centroid = {0, 0, 0};
+  // inertia tensor with respect to the centroid, along the axes of the cloud
+  std::array<std::array<double, 3>, 3> inertia = {};
+};
+
+/** @brief The state of a computation, passed to
+ * ConvexHullContext::progress after each iteration.
+ */
+struct Progress {
+  // the vertices added to the hull after the initial tethraedron
+  std::size_t iterations;
+  // the distance of the farthest vertex still outside the hull from the
+  // facet it is in front of, 0 when none is left
+  double distance;
+};
+
 struct ConvexHullContext {
   std::size_t max_iterations = 1000;
+  // nullopt: serial computation, 0: use all the available cores, otherwise
+  // the number of threads to use. Ignored when thread_pool is specified.
   std::optional<std::size_t> thread_pool_size = std::nullopt;
+  // an externally owned pool, which should outlive the convex_hull call
+  ThreadPool *thread_pool = nullptr;
+  // the work of an iteration is split among the threads of the pool only
+  // when involving at least this number of elements (vertices or facets),
+  // otherwise it is done by the calling thread
+  std::size_t parallel_threshold = 1024;
+  // The maximum number of vertices added to the hull before updating the
+  // outside sets of the new facets. Each batch is made by the farthest
+  // vertices of the facets having the farthest ones, skipping the vertices
+  // whose visible region overlaps the one of a previous vertex of the same
+  // batch. The outside sets are then updated once for the whole batch,
+  // reducing the synchronizations among the threads of the pool. Values
+  // greater than 1 pay off for big clouds having many vertices on the hull.
+  std::size_t batch_size = 1;
+  // pays off for dense clouds, whose points are mostly inside the hull
+  InteriorCulling interior_culling = InteriorCulling::NONE;
+  // DIVIDE_AND_CONQUER is used only for clouds made of at least
+  // parallel_threshold points
+  ParallelMode parallel_mode = ParallelMode::PER_ITERATION;
+  // When true, the internal copy of the points is ordered along a Z-order
+  // (Morton) curve, so that the points close in space are close in memory as
+  // well, reducing the cache misses when scanning the vertices in front of
+  // each facet. The incidences refer anyway to the original positions. In
+  // DIVIDE_AND_CONQUER mode, the cloud is split in chunks of equal size along
+  // the curve, rather than in slabs. Ignored by IncrementalHull.
+  bool spatial_sort = false;
+  // nullopt: the exact convex hull is computed, unless max_iterations is
+  // reached. In DIVIDE_AND_CONQUER mode, the hulls of the chunks ignore the
+  // approximation, which only applies to the final hull.
+  std::optional<Approximation> approximation = std::nullopt;
+  // When not null, it is overwritten by each computation using this context.
+  // Collecting the stats only involves some work per iteration (never per
+  // point) and none at all when left to nullptr. In DIVIDE_AND_CONQUER mode
+  // the counters refer to the final hull, while the chunks computation is
+  // accounted in setup_time. Ignored by convex_hull_batch.
+  ConvexHullStats *stats = nullptr;
+  // When not null, it is overwritten by each computation using this context
+  // with the mass properties of the resulting hull. They are accumulated
+  // while the facets are extracted, in the same pass filling incidences and
+  // normals. Ignored by convex_hull_batch, see
+  // BatchResult::compute_mass_properties.
+  MassProperties *mass_properties = nullptr;
+  // When not null, the timeline of the computations using this context is
+  // recorded into it, see Tracer. It can be shared by many computations, also
+  // running in parallel.
+  Tracer *tracer = nullptr;
+  // When not null, the iterations stop as soon as the token is cancelled,
+  // see CancellationToken. The hull built so far is returned, as when
+  // max_iterations is reached. In DIVIDE_AND_CONQUER mode, only the
+  // iterations of the final hull are stopped: the chunk hulls are complete.
+  const CancellationToken *cancellation = nullptr;
+  // The iterations stop once this time is passed, returning the hull built
+  // so far. The initial tethraedron is anyway built. As for cancellation, in
+  // DIVIDE_AND_CONQUER mode only the final hull is truncated.
+  std::optional<std::chrono::steady_clock::time_point> deadline =
+      std::nullopt;
+  // When not empty, called by the thread computing the hull after each
+  // iteration. In DIVIDE_AND_CONQUER mode, only the iterations of the final
+  // hull are notified. Ignored by convex_hull_batch.
+  std::function<void(const Progress &)> progress = nullptr;
 };
 
 /** @brief The convex hull is built starting from a point cloud described by
@@ -40,6 +243,16 @@ std::vector<FacetIncidences>
 convex_hull(const std::vector<hull::Coordinate> &points,
             const ConvexHullContext &cntx = ConvexHullContext{});
 
+/** @brief Same as above, reading the points from an external buffer.
+ */
+std::vector<FacetIncidences>
+convex_hull(const PointsView &points,
+            const ConvexHullContext &cntx = ConvexHullContext{});
+
+std::vector<FacetIncidences>
+convex_hull(const PointsViewD &points,
+            const ConvexHullContext &cntx = ConvexHullContext{});
+
 template <typename VerticesIterator, typename CoordinateConverter>
 std::vector<FacetIncidences>
 convex_hull(const VerticesIterator &vertices_begin,
@@ -76,6 +289,18 @@ convex_hull(const std::vector<hull::Coordinate> &points,
             std::vector<hull::Coordinate> &convex_hull_normals,
             const ConvexHullContext &cntx = ConvexHullContext{});
 
+/** @brief Same as above, reading the points from an external buffer.
+ */
+std::vector<FacetIncidences>
+convex_hull(const PointsView &points,
+            std::vector<hull::Coordinate> &convex_hull_normals,
+            const ConvexHullContext &cntx = ConvexHullContext{});
+
+std::vector<FacetIncidences>
+convex_hull(const PointsViewD &points,
+            std::vector<hull::Coordinate> &convex_hull_normals,
+            const ConvexHullContext &cntx = ConvexHullContext{});
+
 template <typename VerticesIterator, typename CoordinateConverter>
 std::vector<FacetIncidences>
 convex_hull(const VerticesIterator &vertices_begin,
@@ -84,6 +309,7 @@ convex_hull(const VerticesIterator &vertices_begin,
             std::vector<hull::Coordinate> &convex_hull_normals,
             const ConvexHullContext &cntx = ConvexHullContext{}) {
   std::vector<hull::Coordinate> points;
+  points.reserve(std::distance(vertices_begin, vertices_end));
   std::for_each(vertices_begin, vertices_end,
                 [&points, &converter](const auto &element) {
                   points.push_back(converter(element));
@@ -0,0 +1,61 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include <memory>
+
+namespace qh {
+/** @brief Computes convex hulls one after the other, keeping all the
+ * internal buffers from one computation to the next one.
+ * After the first computations have grown the buffers, computing the convex
+ * hull of clouds of similar size does not require new allocations.
+ */
+class HullEngine {
+public:
+  HullEngine(const ConvexHullContext &cntx = ConvexHullContext{});
+  ~HullEngine();
+
+  HullEngine(const HullEngine &) = delete;
+  HullEngine &operator=(const HullEngine &) = delete;
+  HullEngine(HullEngine &&);
+  HullEngine &operator=(HullEngine &&);
+
+  const ConvexHullContext &getContext() const { return context; }
+  void setContext(const ConvexHullContext &cntx) { context = cntx; }
+
+  /** @brief Computes the convex hull of the passed cloud.
+   * @return the incidences of the facets composing the convex hull, see also
+   * convex_hull. The returned reference is valid until the next compute.
+   */
+  const std::vector<FacetIncidences> &
+  compute(const std::vector<hull::Coordinate> &points);
+
+  /** @brief Same as above, reading the points from an external buffer.
+   */
+  const std::vector<FacetIncidences> &compute(const PointsView &points);
+
+  const std::vector<FacetIncidences> &compute(const PointsViewD &points);
+
+  /** @return the incidences computed by the last compute.
+   */
+  const std::vector<FacetIncidences> &getIncidences() const;
+
+  /** @return the outgoing normals of the facets computed by the last
+   * compute, in the same order of the incidences.
+   */
+  const std::vector<hull::Coordinate> &getNormals() const;
+
+private:
+  ConvexHullContext context;
+
+  struct Workspace;
+  std::unique_ptr<Workspace> workspace;
+};
+} // namespace qh
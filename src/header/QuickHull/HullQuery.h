@@ -0,0 +1,92 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace qh {
+/** @brief Answers support and containment queries about a convex hull
+ * computed by convex_hull, in sublinear time.
+ * The vertices of the hull are linked by its edges and the facets by their
+ * neighbourhood: both graphs are walked greedily, since a linear function has
+ * no local maxima over the vertices of a convex polytope other than the global
+ * one. The points of the cloud are copied, the object stays valid when the
+ * passed buffers are destroyed.
+ * All the queries are const and can be called by many threads at the same
+ * time.
+ */
+class HullQuery {
+public:
+  /** @param points the cloud whose convex hull was computed.
+   * @param incidences the result of convex_hull.
+   * @param normals the normals of the facets, computed together with the
+   * incidences.
+   * @throw Error when incidences and normals have a different size, or they
+   * don't describe a closed surface.
+   */
+  HullQuery(const std::vector<hull::Coordinate> &points,
+            const std::vector<FacetIncidences> &incidences,
+            const std::vector<hull::Coordinate> &normals);
+
+  HullQuery(const PointsView &points,
+            const std::vector<FacetIncidences> &incidences,
+            const std::vector<hull::Coordinate> &normals);
+
+  ~HullQuery();
+
+  HullQuery(const HullQuery &) = delete;
+  HullQuery &operator=(const HullQuery &) = delete;
+  HullQuery(HullQuery &&);
+  HullQuery &operator=(HullQuery &&);
+
+  /** @return the position in the cloud of the vertex of the hull farthest
+   * along direction, which doesn't need to be normalized.
+   */
+  std::size_t support(const hull::Coordinate &direction) const;
+
+  /** @brief Same as above, starting the search from hint, which should be
+   * the position in the cloud of a vertex of the hull, typically the result
+   * of a previous query along a close direction (as in the iterations of
+   * GJK). Any other value is ignored.
+   */
+  std::size_t support(const hull::Coordinate &direction,
+                      std::size_t hint) const;
+
+  /** @return true when point is inside the hull, or closer to its surface
+   * than the tolerance: the same fraction of the greatest extent of the
+   * bounding box of the hull used by the single precision convex_hull.
+   */
+  bool contains(const hull::Coordinate &point) const;
+
+  /** @brief Tests many points at once, with the simd kernels of the library,
+   * comparing each point against all the facets.
+   * Pays off over the single point version when testing many points against
+   * hulls made of few facets.
+   * @param result resized to the number of points: result[k] is 1 when the
+   * k-th point is contained, 0 otherwise.
+   */
+  void contains(const PointsView &points,
+                std::vector<std::uint8_t> &result) const;
+
+  void contains(const std::vector<hull::Coordinate> &points,
+                std::vector<std::uint8_t> &result) const;
+
+  std::size_t verticesSize() const;
+
+  std::size_t facetsSize() const;
+
+  float getTolerance() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+} // namespace qh
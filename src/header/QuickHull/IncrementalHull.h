@@ -0,0 +1,70 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include <memory>
+
+namespace qh {
+/** @brief A convex hull grown over time, by inserting new points into it.
+ * The points passed to all the insert calls are accumulated into a single
+ * cloud, in the order they were inserted: the incidences refer to the
+ * positions in such a cloud.
+ * At each insert, only the new points are compared against the facets of the
+ * current hull, which is expanded only where some of them lie outside of it.
+ */
+class IncrementalHull {
+public:
+  IncrementalHull(const ConvexHullContext &cntx = ConvexHullContext{});
+  ~IncrementalHull();
+
+  IncrementalHull(const IncrementalHull &) = delete;
+  IncrementalHull &operator=(const IncrementalHull &) = delete;
+  IncrementalHull(IncrementalHull &&);
+  IncrementalHull &operator=(IncrementalHull &&);
+
+  const ConvexHullContext &getContext() const { return context; }
+  // ConvexHullContext::max_iterations limits the iterations done by each
+  // insert. ConvexHullContext::interior_culling is used only when building
+  // the first hull. The tolerance and the budgets of
+  // ConvexHullContext::approximation are applied to each insert, while the
+  // coreset is ignored.
+  void setContext(const ConvexHullContext &cntx) { context = cntx; }
+
+  /** @brief Adds the passed points to the cloud, updating the hull.
+   * The hull is built as soon as the inserted points span a non null
+   * volume: before that, the incidences and the normals are empty.
+   */
+  void insert(const std::vector<hull::Coordinate> &points);
+
+  /** @brief Same as above, reading the points from an external buffer.
+   */
+  void insert(const PointsView &points);
+
+  /** @return the number of points inserted so far.
+   */
+  std::size_t size() const;
+
+  /** @return the incidences of the facets of the current hull. The returned
+   * reference is updated by the next insert.
+   */
+  const std::vector<FacetIncidences> &getIncidences() const;
+
+  /** @return the outgoing normals of the facets of the current hull, in the
+   * same order of the incidences.
+   */
+  const std::vector<hull::Coordinate> &getNormals() const;
+
+private:
+  ConvexHullContext context;
+
+  struct State;
+  std::unique_ptr<State> state;
+};
+} // namespace qh
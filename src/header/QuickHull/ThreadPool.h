@@ -0,0 +1,53 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace qh {
+/** @brief A pool of persistent threads, that can be reused by many
+ * convex_hull calls by passing it inside the ConvexHullContext.
+ * Threads are spawned at construction and joined at destruction: between the
+ * two they sleep waiting for work.
+ */
+class ThreadPool {
+public:
+  /** @param size the number of threads working on each task, including the
+   * one calling parallelFor. 0 means as many as the available cores.
+   * @param pin_threads when true, on Linux each worker thread is bound to a
+   * different core.
+   */
+  ThreadPool(std::size_t size = 0, bool pin_threads = false);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  std::size_t size() const;
+
+  using Task = std::function<void(std::size_t begin, std::size_t end)>;
+
+  /** @brief Splits [0, range) into chunks processed by task, with the
+   * calling thread taking part to the work. Returns when all the chunks have
+   * been processed.
+   * Chunks are dynamically assigned to the threads as soon as they get free,
+   * so that uneven chunks are balanced among them.
+   * Tasks submitted by different threads are processed one at a time.
+   * @param chunk_size the size of each chunk. 0 means automatically chosen
+   * from the range and the pool size.
+   */
+  void parallelFor(std::size_t range, const Task &task,
+                   std::size_t chunk_size = 0);
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+} // namespace qh
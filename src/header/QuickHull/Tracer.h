@@ -0,0 +1,64 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace qh {
+/** @brief Records the timeline of the convex hull computations using it,
+ * when passed through ConvexHullContext::tracer.
+ * Every thread taking part to a computation records the spans of the phases
+ * it executes into its own ring buffer, without any locking. When a buffer is
+ * full, the oldest spans are overwritten.
+ * The spans can be exported in the Chrome trace event format, which can be
+ * visualized by chrome://tracing or https://ui.perfetto.dev.
+ */
+class Tracer {
+public:
+  /** @param capacity the number of spans kept for each thread.
+   */
+  Tracer(std::size_t capacity = 1 << 16);
+  ~Tracer();
+
+  Tracer(const Tracer &) = delete;
+  Tracer &operator=(const Tracer &) = delete;
+
+  using Clock = std::chrono::steady_clock;
+
+  /** @brief Stores a span in the buffer of the calling thread.
+   * name and arg_name should be string literals, as only the pointers are
+   * stored. arg_name can be nullptr, when the span has no argument.
+   */
+  void record(const char *name, Clock::time_point begin, Clock::time_point end,
+              const char *arg_name = nullptr, std::size_t arg_value = 0);
+
+  /** @return the number of spans currently stored, among all the threads.
+   */
+  std::size_t size() const;
+
+  /** @brief Forgets all the recorded spans.
+   * Should not be called while a computation is using this tracer, as well
+   * as the dump functions.
+   */
+  void clear();
+
+  void dump(std::ostream &recipient) const;
+
+  /** @throw Error when the file can't be opened.
+   */
+  void dump(const std::string &fileName) const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+} // namespace qh
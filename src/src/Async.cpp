@@ -0,0 +1,42 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include <QuickHull/Async.h>
+
+#include <utility>
+
+namespace qh {
+namespace {
+template <typename Points>
+std::future<ConvexHullResult>
+convex_hull_async_(Points points, const ConvexHullContext &cntx) {
+  return std::async(std::launch::async,
+                    [points = std::move(points), cntx]() {
+                      ConvexHullResult result;
+                      result.incidences =
+                          convex_hull(points, result.normals, cntx);
+                      return result;
+                    });
+}
+} // namespace
+
+std::future<ConvexHullResult>
+convex_hull_async(std::vector<hull::Coordinate> points,
+                  const ConvexHullContext &cntx) {
+  return convex_hull_async_(std::move(points), cntx);
+}
+
+std::future<ConvexHullResult> convex_hull_async(const PointsView &points,
+                                                const ConvexHullContext &cntx) {
+  return convex_hull_async_(points, cntx);
+}
+
+std::future<ConvexHullResult> convex_hull_async(const PointsViewD &points,
+                                                const ConvexHullContext &cntx) {
+  return convex_hull_async_(points, cntx);
+}
+} // namespace qh
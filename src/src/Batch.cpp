@@ -0,0 +1,158 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include <QuickHull/Batch.h>
+#include <QuickHull/Error.h>
+#include <QuickHull/HullEngine.h>
+
+#include "Pools.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace qh {
+// Each lane is processed by a single thread, computing the hulls of the
+// clouds it takes one after the other and appending them to its own buffers.
+// The lanes are then flattened in the order of the clouds.
+struct BatchResult::Workspace {
+  struct Lane {
+    std::vector<FacetIncidences> incidences;
+    std::vector<hull::Coordinate> normals;
+  };
+  std::vector<Lane> lanes;
+
+  // where the hull of each cloud was stored
+  struct Slot {
+    std::size_t lane;
+    std::size_t begin;
+    std::size_t size;
+  };
+  std::vector<Slot> slots;
+};
+
+BatchResult::BatchResult() : workspace(std::make_unique<Workspace>()) {}
+BatchResult::~BatchResult() = default;
+BatchResult::BatchResult(BatchResult &&) = default;
+BatchResult &BatchResult::operator=(BatchResult &&) = default;
+
+double BatchResult::hullsPerSecond() const {
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  return (seconds == 0) ? 0 : static_cast<double>(size()) / seconds;
+}
+
+namespace {
+template <typename Cloud>
+void convex_hull_batch_(const Cloud *clouds, std::size_t clouds_size,
+                        BatchResult &result, BatchResult::Workspace &workspace,
+                        const ConvexHullContext &cntx) {
+  auto tic = std::chrono::steady_clock::now();
+
+  ThreadPool *pool = get_pool(cntx);
+  // every hull is computed by a single thread
+  ConvexHullContext hull_cntx = cntx;
+  hull_cntx.thread_pool = nullptr;
+  hull_cntx.thread_pool_size = std::nullopt;
+  // the engines of the different threads can't share the same stats
+  hull_cntx.stats = nullptr;
+  hull_cntx.mass_properties = nullptr;
+  // nor call the same callback concurrently
+  hull_cntx.progress = nullptr;
+  result.mass_properties.resize(result.compute_mass_properties ? clouds_size
+                                                               : 0);
+  result.errors.resize(clouds_size);
+
+  const std::size_t lanes_size = (pool == nullptr) ? 1 : pool->size();
+  workspace.lanes.resize(lanes_size);
+  workspace.slots.resize(clouds_size);
+  // the clouds are dynamically assigned to the lanes, as soon as they get
+  // free
+  std::atomic_size_t next_cloud = 0;
+  auto compute = [&](std::size_t begin, std::size_t end) {
+    // engines are kept by each thread, in order to reuse their buffers
+    thread_local HullEngine engine;
+    for (std::size_t l = begin; l < end; ++l) {
+      auto &lane = workspace.lanes[l];
+      lane.incidences.clear();
+      lane.normals.clear();
+      for (std::size_t k = next_cloud++; k < clouds_size; k = next_cloud++) {
+        ConvexHullContext cloud_cntx = hull_cntx;
+        if (result.compute_mass_properties) {
+          // each hull writes its own slot
+          cloud_cntx.mass_properties = &result.mass_properties[k];
+        }
+        engine.setContext(cloud_cntx);
+        auto &slot = workspace.slots[k];
+        slot = BatchResult::Workspace::Slot{l, lane.incidences.size(), 0};
+        result.errors[k].clear();
+        try {
+          const auto &incidences = engine.compute(clouds[k]);
+          lane.incidences.insert(lane.incidences.end(), incidences.begin(),
+                                 incidences.end());
+          lane.normals.insert(lane.normals.end(),
+                              engine.getNormals().begin(),
+                              engine.getNormals().end());
+          slot.size = incidences.size();
+        } catch (const Error &e) {
+          // the other hulls are anyway computed
+          result.errors[k] = e.what();
+          if (result.compute_mass_properties) {
+            result.mass_properties[k] = MassProperties{};
+          }
+        }
+      }
+    }
+  };
+  if (pool == nullptr) {
+    compute(0, lanes_size);
+  } else {
+    pool->parallelFor(lanes_size, compute, 1);
+  }
+
+  result.offsets.resize(clouds_size + 1);
+  result.offsets.front() = 0;
+  for (std::size_t k = 0; k < clouds_size; ++k) {
+    result.offsets[k + 1] = result.offsets[k] + workspace.slots[k].size;
+  }
+  result.incidences.resize(result.offsets.back());
+  result.normals.resize(result.offsets.back());
+  auto flatten = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t k = begin; k < end; ++k) {
+      const auto &slot = workspace.slots[k];
+      const auto &lane = workspace.lanes[slot.lane];
+      std::copy_n(lane.incidences.begin() + slot.begin, slot.size,
+                  result.incidences.begin() + result.offsets[k]);
+      std::copy_n(lane.normals.begin() + slot.begin, slot.size,
+                  result.normals.begin() + result.offsets[k]);
+    }
+  };
+  if (pool == nullptr) {
+    flatten(0, clouds_size);
+  } else {
+    pool->parallelFor(clouds_size, flatten);
+  }
+
+  result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - tic);
+}
+} // namespace
+
+void convex_hull_batch(const std::vector<hull::Coordinate> *clouds,
+                       std::size_t clouds_size, BatchResult &result,
+                       const ConvexHullContext &cntx) {
+  convex_hull_batch_(clouds, clouds_size, result, *result.workspace, cntx);
+}
+
+void convex_hull_batch(const PointsView *clouds, std::size_t clouds_size,
+                       BatchResult &result, const ConvexHullContext &cntx) {
+  convex_hull_batch_(clouds, clouds_size, result, *result.workspace, cntx);
+}
+
+void convex_hull_batch(const std::vector<std::vector<hull::Coordinate>> &clouds,
+                       BatchResult &result, const ConvexHullContext &cntx) {
+  convex_hull_batch(clouds.data(), clouds.size(), result, cntx);
+}
+} // namespace qh
@@ -1,7 +1,49 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
 namespace qh {
-static constexpr float QHULL_GEOMETRIC_TOLLERANCE = static_cast<float>(1e-3);
-static constexpr float QHULL_GEOMETRIC_TOLLERANCE_SQUARED =
-    QHULL_GEOMETRIC_TOLLERANCE * QHULL_GEOMETRIC_TOLLERANCE;
+// The tolerance of the geometric predicates, for a cloud whose coordinates
+// are at most magnitude in absolute value and whose bounding box has the
+// passed greatest extent
+template <typename Scalar> struct GeometricTolerance;
+
+template <> struct GeometricTolerance<float> {
+  // The points and the facets are compared in single precision, whose
+  // rounding error grows with the magnitude of the coordinates: the
+  // tolerance is a few ulps of the largest one, in order not to discard the
+  // vertices of thin or big clouds.
+  static constexpr float ULPS = 32;
+
+  static float get(float magnitude, float) {
+    return ULPS * std::numeric_limits<float>::epsilon() * magnitude;
+  }
+};
+
+template <> struct GeometricTolerance<double> {
+  // the hull facets are stored in single precision, which bounds the accuracy
+  // of their normals
+  static constexpr double RELATIVE_TOLLERANCE = 1e-6;
+
+  static double get(double, double extent) {
+    return RELATIVE_TOLLERANCE * extent;
+  }
+};
+
+// the tolerance for a cloud whose bounding box spans [min, max]
+template <typename Scalar>
+Scalar box_tolerance(const Scalar *min, const Scalar *max) {
+  Scalar magnitude = 0;
+  Scalar extent = 0;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    magnitude =
+        std::max({magnitude, std::abs(min[axis]), std::abs(max[axis])});
+    extent = std::max(extent, max[axis] - min[axis]);
+  }
+  return std::max(GeometricTolerance<Scalar>::get(magnitude, extent),
+                  std::numeric_limits<Scalar>::min());
+}
 } // namespace qh
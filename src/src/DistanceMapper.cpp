@@ -6,69 +6,300 @@
  **/
 
 #include "DistanceMapper.h"
-#include <omp.h>
+
+#include <algorithm>
+#include <limits>
 
 namespace qh {
-namespace {
-struct Guard {
-  Guard(std::atomic_bool &lock) : lock_{lock} {
-    while (true) {
-      bool expected = true;
-      if (lock_.compare_exchange_strong(
-              expected, false, std::memory_order::memory_order_acquire)) {
-        break;
-      }
+template <typename Scalar>
+void DistanceMapper<Scalar>::reset(ThreadPool *pool,
+                                   std::size_t parallel_threshold) {
+  setParallelism(pool, parallel_threshold);
+  distances.clear();
+  outside_vertices = 0;
+  for (auto &outside_set : outside_sets) {
+    outside_set.clear();
+  }
+  new_facets.clear();
+  new_facets_ends.clear();
+  orphans_ends.clear();
+  // initially, all the open vertices are waiting to be assigned to the facets
+  // of the initial tethraedron
+  orphans.clear();
+  for (std::size_t k = 0; k < cloud.size(); ++k) {
+    if (cloud.isOpen(k)) {
+      orphans.push_back(k);
     }
   }
-  ~Guard() { lock_.store(true, std::memory_order::memory_order_release); }
-
-private:
-  std::atomic_bool &lock_;
-};
-} // namespace
+}
 
-std::optional<DistanceMapper::FacetVertexDistance>
-DistanceMapper::recompute(const hull::Facet *facet) const {
-  const auto &point = last_notification->context.vertices[facet->vertexA];
-  auto info = cloud.getFarthest(point, facet->normal);
+template <typename Scalar>
+std::optional<typename DistanceMapper<Scalar>::FacetVertexDistance>
+DistanceMapper<Scalar>::recompute(Mesh::Index facet) const {
+  const auto &subject = mesh.getFacet(facet);
+  auto farthest =
+      cloud.getFarthest(mesh.getVertex(subject.vertices[0]), subject.normal,
+                        outside_sets[facet]);
   std::optional<FacetVertexDistance> res;
-  if (info.has_value()) {
-    res.emplace(FacetVertexDistance{facet, info->vertex, info->distance});
+  if (farthest.has_value()) {
+    res.emplace(
+        FacetVertexDistance{facet, farthest->vertex, farthest->distance});
   }
   return res;
 }
 
-void DistanceMapper::processLastUpdate() {
-  // changed facets
-#pragma omp for
-  for (int i = 0; i < last_notification->changed.size(); ++i) {
-    const auto *facet = last_notification->changed[i];
-    auto info = recompute(facet);
-    Guard guard{spin_lock};
-    auto it = facets_table.find(facet);
-    distances.erase(it->second);
-    if (info.has_value()) {
-      it->second = distances.emplace(info.value());
+template <typename Scalar>
+void DistanceMapper<Scalar>::collectOrphans(Mesh::Index facet) {
+  if (outside_sets.size() <= facet) {
+    return;
+  }
+  distances.erase(facet);
+  auto &outside_set = outside_sets[facet];
+  orphans.insert(orphans.end(), outside_set.begin(), outside_set.end());
+  outside_vertices -= outside_set.size();
+  outside_set.clear();
+}
+
+template <typename Scalar>
+void DistanceMapper<Scalar>::collectLastUpdate() {
+  const auto &update = mesh.getLastUpdate();
+  if (stats != nullptr) {
+    stats->facets_added += update.added.size();
+    stats->facets_changed += update.changed.size();
+    stats->facets_removed += update.removed.size();
+  }
+  // the vertices in front of the facets that are no more part of the hull
+  // are collected. Only those ones can be in front of the new facets.
+  {
+    TraceSpan span(tracer, "changed facets");
+    span.setArg("facets", update.changed.size());
+    for (const auto facet : update.changed) {
+      collectOrphans(facet);
     }
   }
-  // added facets
-#pragma omp for
-  for (int i = 0; i < last_notification->added.size(); ++i) {
-    const auto *facet = last_notification->added[i];
-    auto info = recompute(facet);
-    if (info.has_value()) {
-      Guard guard{spin_lock};
-      facets_table[facet] = distances.emplace(info.value());
+  {
+    TraceSpan span(tracer, "removed facets");
+    span.setArg("facets", update.removed.size());
+    for (const auto facet : update.removed) {
+      collectOrphans(facet);
     }
   }
-  // removed facets
-#pragma omp for
-  for (int i = 0; i < last_notification->removed.size(); ++i) {
-    const auto *facet = last_notification->removed[i];
-    Guard guard{spin_lock};
-    auto it = facets_table.find(facet);
-    distances.erase(it->second);
-    facets_table.erase(it);
+  orphans_ends.push_back(orphans.size());
+  new_facets.insert(new_facets.end(), update.changed.begin(),
+                    update.changed.end());
+  new_facets.insert(new_facets.end(), update.added.begin(),
+                    update.added.end());
+  new_facets_ends.push_back(new_facets.size());
+}
+
+template <typename Scalar> void DistanceMapper<Scalar>::processUpdates() {
+  distributeOrphans();
+}
+
+template <typename Scalar>
+void DistanceMapper<Scalar>::addVertices(
+    const std::vector<std::size_t> &vertices) {
+  orphans = vertices;
+  orphans_ends = {orphans.size()};
+  mesh.forEachFacet([this](Mesh::Index facet, const Mesh::Facet &) {
+    new_facets.push_back(facet);
+  });
+  new_facets_ends = {new_facets.size()};
+  distributeOrphans();
+}
+
+template <typename Scalar>
+void DistanceMapper<Scalar>::distributeOrphans() {
+  TraceSpan distribute_span(tracer, "added and changed facets");
+  distribute_span.setArg("facets", new_facets.size());
+  if (outside_sets.size() < mesh.facetsCapacity()) {
+    outside_sets.resize(mesh.facetsCapacity());
   }
+  new_distances.resize(new_facets.size());
+  orphans_owner.resize(orphans.size());
+
+  // Each orphan is assigned to the first facet seeing it, among the ones
+  // created by the update that collected it: the regions replaced by the
+  // updates of a batch don't overlap, an orphan not seen by them is inside
+  // the hull. The vertices added to the hull are no more open.
+  forEach(orphans.size(), orphans.size(),
+          [this](std::size_t begin, std::size_t end) {
+            TraceSpan span(tracer, "assign orphans");
+            span.setArg("orphans", end - begin);
+            std::size_t update = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+              while (orphans_ends[update] <= i) {
+                ++update;
+              }
+              int owner = -1;
+              if (cloud.isOpen(orphans[i])) {
+                const int first = (update == 0)
+                                      ? 0
+                                      : static_cast<int>(
+                                            new_facets_ends[update - 1]);
+                const int last = static_cast<int>(new_facets_ends[update]);
+                for (int f = first; f < last; ++f) {
+                  const auto &facet = mesh.getFacet(new_facets[f]);
+                  if (cloud.isInFront(mesh.getVertex(facet.vertices[0]),
+                                      facet.normal, orphans[i])) {
+                    owner = f;
+                    break;
+                  }
+                }
+              }
+              orphans_owner[i] = owner;
+            }
+          });
+
+  // orphans not seen by any new facet are inside the hull: they are simply
+  // forgotten
+  std::size_t assigned_orphans = 0;
+  for (std::size_t i = 0; i < orphans.size(); ++i) {
+    if (orphans_owner[i] != -1) {
+      outside_sets[new_facets[orphans_owner[i]]].push_back(orphans[i]);
+      ++assigned_orphans;
+    }
+  }
+  outside_vertices += assigned_orphans;
+  if (stats != nullptr) {
+    // every orphan was tested against the facets of its update preceding its
+    // owner, or all of them when not owned
+    std::size_t update = 0;
+    for (std::size_t i = 0; i < orphans.size(); ++i) {
+      while (orphans_ends[update] <= i) {
+        ++update;
+      }
+      if (!cloud.isOpen(orphans[i])) {
+        continue;
+      }
+      const std::size_t first =
+          (update == 0) ? 0 : new_facets_ends[update - 1];
+      stats->distance_evaluations +=
+          (orphans_owner[i] == -1)
+              ? new_facets_ends[update] - first
+              : static_cast<std::size_t>(orphans_owner[i]) + 1 - first;
+    }
+    // and then by its owner, looking for the farthest vertex
+    for (const auto facet : new_facets) {
+      stats->distance_evaluations += outside_sets[facet].size();
+    }
+    stats->peak_open_set_size =
+        std::max(stats->peak_open_set_size, outside_vertices);
+  }
+  orphans.clear();
+  orphans_ends.clear();
+
+  // changed and added facets: each thread writes only the slots of the
+  // facets it is processing, with no need to synchronize
+  forEach(new_facets.size(), assigned_orphans,
+          [this](std::size_t begin, std::size_t end) {
+            TraceSpan span(tracer, "farthest vertices");
+            span.setArg("facets", end - begin);
+            for (std::size_t i = begin; i < end; ++i) {
+              new_distances[i] = recompute(new_facets[i]);
+            }
+          });
+
+  // the distances are merged into the heap by the calling thread
+  TraceSpan merge_span(tracer, "heap merge");
+  for (std::size_t i = 0; i < new_facets.size(); ++i) {
+    // facet that already had an outside set before the last vertices were
+    // added
+    distances.erase(new_facets[i]);
+    if (new_distances[i].has_value()) {
+      distances.push(new_distances[i].value(), new_facets[i]);
+    }
+  }
+  new_facets.clear();
+  new_facets_ends.clear();
+}
+
+template <typename Scalar>
+Scalar DistanceMapper<Scalar>::getDistance(
+    const std::vector<std::size_t> &vertices) const {
+  std::vector<Mesh::Index> facets;
+  mesh.forEachFacet([&facets](Mesh::Index facet, const Mesh::Facet &) {
+    facets.push_back(facet);
+  });
+  if (facets.empty()) {
+    return 0;
+  }
+  auto is_in_front = [this](std::size_t vertex, Mesh::Index facet) {
+    const auto &subject = mesh.getFacet(facet);
+    return cloud.isInFront(mesh.getVertex(subject.vertices[0]),
+                           subject.normal, vertex);
+  };
+  auto distance = [this](std::size_t vertex, Mesh::Index facet) {
+    const auto &subject = mesh.getFacet(facet);
+    return cloud.distanceToTriangle(vertex,
+                                    mesh.getVertex(subject.vertices[0]),
+                                    mesh.getVertex(subject.vertices[1]),
+                                    mesh.getVertex(subject.vertices[2]));
+  };
+
+  // The distance of a point outside the hull is the one to the closest
+  // facet, which is usually one near the facet most visible from the point.
+  // Those are checked first and the search among all the other facets stops
+  // as soon as the point turns out not to be the farthest one so far.
+  // the walk towards the most visible facet starts from the best among some
+  // facets spread over the hull
+  std::vector<Mesh::Index> seeds;
+  const std::size_t seeds_stride = std::max<std::size_t>(1, facets.size() / 32);
+  for (std::size_t k = 0; k < facets.size(); k += seeds_stride) {
+    seeds.push_back(facets[k]);
+  }
+  Scalar result = 0;
+  std::vector<Mesh::Index> nearby;
+  for (const auto vertex : vertices) {
+    const auto point = cloud.getPoint(vertex);
+    Mesh::Index owner = seeds.front();
+    float best_seed = std::numeric_limits<float>::lowest();
+    for (const auto seed : seeds) {
+      const float alignment = hull::dot(point, mesh.getFacet(seed).normal);
+      if (best_seed < alignment) {
+        best_seed = alignment;
+        owner = seed;
+      }
+    }
+    owner = mesh.findMostVisible(point, owner);
+    if (!is_in_front(vertex, owner)) {
+      // inside the hull, within the tolerance
+      continue;
+    }
+    // the owner, its neighbours and the neighbours of them: the facets at
+    // most two edge steps away, possibly repeated
+    nearby = {owner};
+    for (const auto neighbour : mesh.getFacet(owner).neighbours) {
+      nearby.push_back(neighbour);
+      for (const auto second : mesh.getFacet(neighbour).neighbours) {
+        nearby.push_back(second);
+      }
+    }
+    Scalar closest = std::numeric_limits<Scalar>::max();
+    for (const auto facet : nearby) {
+      closest = std::min(closest, distance(vertex, facet));
+    }
+    for (auto facet = facets.begin();
+         (result < closest) && (facet != facets.end()); ++facet) {
+      closest = std::min(closest, distance(vertex, *facet));
+    }
+    result = std::max(result, closest);
+  }
+  return result;
 }
+
+template <typename Scalar>
+Scalar DistanceMapper<Scalar>::getOutsideDistance() const {
+  std::vector<std::size_t> vertices;
+  mesh.forEachFacet([&](Mesh::Index facet, const Mesh::Facet &) {
+    if (facet < outside_sets.size()) {
+      vertices.insert(vertices.end(), outside_sets[facet].begin(),
+                      outside_sets[facet].end());
+    }
+  });
+  return getDistance(vertices);
+}
+
+template class DistanceMapper<float>;
+template class DistanceMapper<double>;
 } // namespace qh
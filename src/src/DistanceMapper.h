@@ -7,52 +7,139 @@
 
 #pragma once
 
-#include <Hull/Hull.h>
 #include <QuickHull/FastQuickHull.h>
 
+#include "IndexedHeap.h"
+#include "Mesh.h"
 #include "PointCloud.h"
+#include "TraceSpan.h"
 
-#include <atomic>
 #include <optional>
-#include <set>
-#include <unordered_map>
 
 namespace qh {
-class DistanceMapper : public hull::Observer {
+// Keeps track of the open vertices in front of each facet of mesh, and of
+// the farthest one among all of them.
+// Explicitly instantiated for float and double.
+template <typename Scalar> class DistanceMapper {
 public:
-  DistanceMapper(const PointCloud &cloud) : cloud(cloud){};
+  DistanceMapper(const PointCloud<Scalar> &cloud, const Mesh &mesh)
+      : cloud(cloud), mesh(mesh){};
 
-  void processLastUpdate();
+  // Prepares the mapper for a new computation over the current content of
+  // cloud, reusing the buffers allocated by the previous ones.
+  // pool can be nullptr, meaning that everything is done by the calling
+  // thread
+  void reset(ThreadPool *pool, std::size_t parallel_threshold);
+
+  void setParallelism(ThreadPool *pool, std::size_t parallel_threshold) {
+    this->pool = pool;
+    this->parallel_threshold = parallel_threshold;
+  }
+
+  // stats can be nullptr, meaning that no counter is updated
+  void setStats(ConvexHullStats *stats) { this->stats = stats; }
+
+  // tracer can be nullptr, meaning that nothing is recorded
+  void setTracer(Tracer *tracer) { this->tracer = tracer; }
+
+  // updates the outside sets of the facets modified by the last reset or
+  // update of mesh
+  void processLastUpdate() {
+    collectLastUpdate();
+    processUpdates();
+  }
+
+  // Takes note of the facets modified by the last update of mesh, collecting
+  // the vertices in front of the ones replaced. Allows to update mesh many
+  // times, before paying a single call to processUpdates.
+  void collectLastUpdate();
+
+  // updates the outside sets of the facets modified by the updates of mesh
+  // collected since the last call
+  void processUpdates();
+
+  // Assigns the passed vertices, appended to cloud after the hull was built,
+  // to the facets of the hull in front of them. The ones not seen by any
+  // facet are inside the hull and are simply forgotten.
+  void addVertices(const std::vector<std::size_t> &vertices);
+
+  // The greatest distance between the hull and the passed vertices, 0 for
+  // the ones inside it
+  Scalar getDistance(const std::vector<std::size_t> &vertices) const;
+
+  // the greatest distance between the hull and the vertices in the outside
+  // sets
+  Scalar getOutsideDistance() const;
 
   struct FacetVertexDistance {
-    const hull::Facet *facet;
+    Mesh::Index facet;
     std::size_t vertex_index;
-    float distance;
+    Scalar distance;
 
     bool operator<(const FacetVertexDistance &o) const {
       return distance < o.distance;
     }
   };
 
-  using Distances = std::multiset<FacetVertexDistance>;
+  // the key of each element is its facet
+  using Distances = IndexedHeap<FacetVertexDistance>;
 
   const FacetVertexDistance *getBest() const {
-    return distances.empty() ? nullptr : &(*distances.rbegin());
+    return distances.empty() ? nullptr : &distances.top();
   }
 
-  void hullChanges(const hull::Observer::Notification &notification) override {
-    last_notification.emplace(notification);
-  };
+  // the farthest vertices of the count facets having the farthest ones, in
+  // decreasing order of distance
+  void getBest(std::size_t count,
+               std::vector<FacetVertexDistance> &recipient) const {
+    distances.getGreatest(count, recipient);
+  }
 
 protected:
-  const PointCloud &cloud;
+  const PointCloud<Scalar> &cloud;
+  const Mesh &mesh;
+  ThreadPool *pool = nullptr;
+  std::size_t parallel_threshold = 0;
+  ConvexHullStats *stats = nullptr;
+  Tracer *tracer = nullptr;
 
-  std::optional<hull::Observer::Notification> last_notification;
+  // body(begin, end) is called on [0, size), splitting the range among the
+  // threads of the pool only if the number of involved elements is big enough
+  template <typename Body>
+  void forEach(std::size_t size, std::size_t involved_elements,
+               const Body &body) {
+    if ((pool == nullptr) || (involved_elements < parallel_threshold)) {
+      body(std::size_t{0}, size);
+      return;
+    }
+    pool->parallelFor(size, body);
+  }
 
-  std::atomic_bool spin_lock = true;
-  std::unordered_map<const hull::Facet *, Distances::iterator> facets_table;
+  // the open vertices in front of each facet (conflict list), indexed as the
+  // facets of mesh. The outside sets of the facets removed from mesh are
+  // empty, ready to be recycled together with their slot.
+  std::vector<std::vector<std::size_t>> outside_sets;
   Distances distances;
+  // sum of the sizes of the outside sets
+  std::size_t outside_vertices = 0;
+
+  // vertices whose owning facet disappeared from the hull since the last
+  // update and that should be assigned to one of the new facets
+  std::vector<std::size_t> orphans;
+  std::vector<Mesh::Index> new_facets;
+  // The updates collected since the last processUpdates: the orphans
+  // collected by the k-th one end at orphans_ends[k] and the facets it
+  // created at new_facets_ends[k]
+  std::vector<std::size_t> orphans_ends;
+  std::vector<std::size_t> new_facets_ends;
+  std::vector<std::optional<FacetVertexDistance>> new_distances;
+  std::vector<int> orphans_owner;
+
+  // assigns the orphans to the facets in new_facets, updating the distances
+  void distributeOrphans();
+
+  void collectOrphans(Mesh::Index facet);
 
-  std::optional<FacetVertexDistance> recompute(const hull::Facet *facet) const;
+  std::optional<FacetVertexDistance> recompute(Mesh::Index facet) const;
 };
 } // namespace qh
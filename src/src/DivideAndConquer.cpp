@@ -0,0 +1,189 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include <QuickHull/Error.h>
+
+#include "Definitions.h"
+#include "DivideAndConquer.h"
+#include "TraceSpan.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace qh {
+namespace {
+// a little bit of oversubscription helps balancing chunks of uneven size
+static constexpr std::size_t CHUNKS_PER_THREAD = 2;
+} // namespace
+
+template <typename Scalar>
+template <typename Pred>
+void DivideAndConquer<Scalar>::splitInSlabs(
+    const BasicPointsView<Scalar> &points, const Scalar *min,
+    const Scalar *max, std::size_t chunks_size, const Pred &add_to_chunk) {
+  // slabs of equal width along the longest side of the bounding box
+  std::size_t axis = 0;
+  for (std::size_t a = 1; a < 3; ++a) {
+    if ((max[axis] - min[axis]) < (max[a] - min[a])) {
+      axis = a;
+    }
+  }
+  const Scalar slab_width =
+      (max[axis] - min[axis]) / static_cast<Scalar>(chunks_size);
+  for (std::size_t k = 0; k < points.size; ++k) {
+    const Scalar *point = points.data + k * points.stride;
+    std::size_t slab = 0;
+    if (slab_width > 0) {
+      slab = std::min(
+          chunks_size - 1,
+          static_cast<std::size_t>((point[axis] - min[axis]) / slab_width));
+    }
+    add_to_chunk(slab, k);
+  }
+}
+
+template <typename Scalar>
+template <typename Pred>
+void DivideAndConquer<Scalar>::splitAlongCurve(
+    const BasicPointsView<Scalar> &points, std::size_t chunks_size,
+    const Pred &add_to_chunk) {
+  // consecutive ranges of the same size along the Morton curve, each one
+  // spanning a compact region of space
+  const auto &order = morton_order.sort(points);
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    add_to_chunk(k * chunks_size / order.size(), order[k]);
+  }
+}
+
+template <typename Scalar>
+void DivideAndConquer<Scalar>::compute(
+    const BasicPointsView<Scalar> &points, ThreadPool &pool,
+    const ConvexHullContext &cntx, Pipeline<Scalar> &pipeline,
+    std::vector<FacetIncidences> &incidences,
+    std::vector<hull::Coordinate> &normals) {
+  // the same checks of PointCloud::reset, as the bounding box below reads the
+  // first point
+  if (points.size < 4) {
+    throw Error{"The point cloud should have at least 4 points"};
+  }
+  if (points.stride < 3) {
+    throw Error{"The stride of the points should be at least 3"};
+  }
+  const auto tic = std::chrono::steady_clock::now();
+  const std::size_t chunks_size = pool.size() * CHUNKS_PER_THREAD;
+  while (chunks.size() < chunks_size) {
+    chunks.emplace_back(std::make_unique<Chunk>());
+  }
+
+  for (std::size_t c = 0; c < chunks_size; ++c) {
+    chunks[c]->points.clear();
+    chunks[c]->indices.clear();
+  }
+  auto add_to_chunk = [&](std::size_t chunk, std::size_t index) {
+    const Scalar *point = points.data + index * points.stride;
+    auto &recipient = *chunks[chunk];
+    recipient.points.insert(recipient.points.end(), point, point + 3);
+    recipient.indices.push_back(index);
+  };
+  Scalar min[3] = {points.data[0], points.data[1], points.data[2]};
+  Scalar max[3] = {points.data[0], points.data[1], points.data[2]};
+  for (std::size_t k = 0; k < points.size; ++k) {
+    const Scalar *point = points.data + k * points.stride;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      min[axis] = std::min(min[axis], point[axis]);
+      max[axis] = std::max(max[axis], point[axis]);
+    }
+  }
+  if (cntx.spatial_sort) {
+    splitAlongCurve(points, chunks_size, add_to_chunk);
+  } else {
+    splitInSlabs(points, min, max, chunks_size, add_to_chunk);
+  }
+  // A chunk is possibly much thinner than the cloud: its hull is computed
+  // with a tolerance not greater than the one of the whole cloud, so that
+  // the points it discards are within that tolerance from the final hull.
+  const Scalar tolerance = box_tolerance(min, max);
+
+  // every chunk hull is computed by a single thread, and without
+  // approximation: a vertex missing from a chunk hull is missing from the
+  // final one
+  ConvexHullContext chunk_cntx = cntx;
+  chunk_cntx.thread_pool = nullptr;
+  chunk_cntx.thread_pool_size = std::nullopt;
+  chunk_cntx.stats = nullptr;
+  chunk_cntx.mass_properties = nullptr;
+  chunk_cntx.approximation = std::nullopt;
+  // the points of each chunk are already sorted along the curve
+  chunk_cntx.spatial_sort = false;
+  chunk_cntx.progress = nullptr;
+  // a truncated chunk hull would lose vertices of the final one: the
+  // cancellation and the deadline only stop the final pass
+  chunk_cntx.cancellation = nullptr;
+  chunk_cntx.deadline = std::nullopt;
+  pool.parallelFor(
+      chunks_size,
+      [&](std::size_t begin, std::size_t end) {
+        auto hull_cntx = chunk_cntx;
+        for (std::size_t c = begin; c < end; ++c) {
+          auto &chunk = *chunks[c];
+          TraceSpan span(cntx.tracer, "chunk hull");
+          span.setArg("points", chunk.indices.size());
+          chunk.vertices.clear();
+          hull_cntx.max_iterations = chunk.indices.size();
+          try {
+            compute_hull(chunk.pipeline,
+                         BasicPointsView<Scalar>{chunk.points.data(),
+                                                 chunk.indices.size()},
+                         hull_cntx, chunk.incidences, chunk.normals,
+                         std::optional<Scalar>{tolerance});
+          } catch (const Error &) {
+            // too few points or null volume: all of them are kept
+            chunk.vertices = chunk.indices;
+            continue;
+          }
+          for (const auto &facet : chunk.incidences) {
+            for (const auto vertex : facet) {
+              chunk.vertices.push_back(chunk.indices[vertex]);
+            }
+          }
+        }
+      },
+      1);
+
+  candidates.clear();
+  for (std::size_t c = 0; c < chunks_size; ++c) {
+    candidates.insert(candidates.end(), chunks[c]->vertices.begin(),
+                      chunks[c]->vertices.end());
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+  candidates_points.clear();
+  for (const auto index : candidates) {
+    const Scalar *point = points.data + index * points.stride;
+    candidates_points.insert(candidates_points.end(), point, point + 3);
+  }
+  const auto chunks_time = std::chrono::steady_clock::now() - tic;
+
+  compute_hull(pipeline,
+               BasicPointsView<Scalar>{candidates_points.data(),
+                                       candidates.size()},
+               cntx, incidences, normals);
+  if (cntx.stats != nullptr) {
+    cntx.stats->setup_time +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(chunks_time);
+  }
+  for (auto &facet : incidences) {
+    for (auto &vertex : facet) {
+      vertex = candidates[vertex];
+    }
+  }
+}
+
+template class DivideAndConquer<float>;
+template class DivideAndConquer<double>;
+} // namespace qh
@@ -0,0 +1,63 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include "MortonOrder.h"
+#include "Pipeline.h"
+
+#include <memory>
+#include <vector>
+
+namespace qh {
+// Computes the convex hull of a cloud split into chunks: slabs along the
+// longest side of its bounding box, or ranges of its Morton curve when
+// ConvexHullContext::spatial_sort is true. The hulls of the chunks are
+// computed in parallel, each one by a single thread of the pool, with a
+// tolerance not greater than the one of the whole cloud. Only the vertices of
+// the chunk hulls are considered for computing the final hull: the points
+// they discard are within the tolerance from it.
+// Explicitly instantiated for float and double.
+template <typename Scalar> class DivideAndConquer {
+public:
+  // the final hull is computed using pipeline
+  void compute(const BasicPointsView<Scalar> &points, ThreadPool &pool,
+               const ConvexHullContext &cntx, Pipeline<Scalar> &pipeline,
+               std::vector<FacetIncidences> &incidences,
+               std::vector<hull::Coordinate> &normals);
+
+private:
+  struct Chunk {
+    Pipeline<Scalar> pipeline;
+    // the coordinates of the points in the chunk
+    std::vector<Scalar> points;
+    // the positions of the points in the original cloud
+    std::vector<std::size_t> indices;
+
+    std::vector<FacetIncidences> incidences;
+    std::vector<hull::Coordinate> normals;
+    // positions in the original cloud of the vertices of the chunk hull
+    std::vector<std::size_t> vertices;
+  };
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  MortonOrder<Scalar> morton_order;
+
+  // add_to_chunk(chunk, index) is called for each point of the cloud
+  // min and max delimit the bounding box of the cloud
+  template <typename Pred>
+  void splitInSlabs(const BasicPointsView<Scalar> &points, const Scalar *min,
+                    const Scalar *max, std::size_t chunks_size,
+                    const Pred &add_to_chunk);
+  template <typename Pred>
+  void splitAlongCurve(const BasicPointsView<Scalar> &points,
+                       std::size_t chunks_size, const Pred &add_to_chunk);
+
+  // the vertices of all the chunk hulls
+  std::vector<std::size_t> candidates;
+  std::vector<Scalar> candidates_points;
+};
+} // namespace qh
@@ -5,147 +5,497 @@
  * report any bug to andrecasa91@gmail.com.
  **/
 
-#include <Hull/Hull.h>
 #include <QuickHull/FastQuickHull.h>
+#include <QuickHull/Async.h>
+#include <QuickHull/Error.h>
+#include <QuickHull/HullEngine.h>
+#include <QuickHull/IncrementalHull.h>
 
-#include "DistanceMapper.h"
+#include "DivideAndConquer.h"
+#include "Pipeline.h"
+#include "Pools.h"
+#include "TraceSpan.h"
 
 #include <algorithm>
-#include <omp.h>
-#include <unordered_map>
+#include <chrono>
+#include <memory>
+#include <optional>
 
 namespace qh {
 namespace {
-int get_default_pool_size() {
-  int result = 0;
-#pragma omp parallel
-  {
-    if (0 == omp_get_thread_num()) {
-      result = omp_get_num_threads();
+// Adds to the specified member of stats the time elapsed from construction to
+// destruction. Does nothing when stats is nullptr.
+class ScopedTimer {
+public:
+  ScopedTimer(ConvexHullStats *stats,
+              std::chrono::nanoseconds ConvexHullStats::*member)
+      : stats(stats), member(member) {
+    if (stats != nullptr) {
+      tic = std::chrono::steady_clock::now();
     }
   }
-  return result;
-}
-
-static const int DEAFULT_POOL_SIZE = get_default_pool_size();
 
-int get_pool_size(const std::optional<std::size_t> &thread_pool_size) {
-  int pool_size = 1;
-  if (thread_pool_size != std::nullopt) {
-    if (*thread_pool_size == 0) {
-      pool_size = DEAFULT_POOL_SIZE;
-    } else {
-      pool_size = static_cast<int>(*thread_pool_size);
+  ~ScopedTimer() {
+    if (stats != nullptr) {
+      stats->*member += std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - tic);
     }
   }
-  return pool_size;
-}
 
-using HullIndexVSPointCloudIndexMap =
-    std::unordered_map<std::size_t, std::size_t>;
+private:
+  ConvexHullStats *stats;
+  std::chrono::nanoseconds ConvexHullStats::*member;
+  std::chrono::steady_clock::time_point tic;
+};
 
-hull::Hull convex_hull_(PointCloud &points, const ConvexHullContext &cntx,
-                        HullIndexVSPointCloudIndexMap &indices_map) {
-  DistanceMapper mapper(points);
-  indices_map.clear();
+void reset_stats(const ConvexHullContext &cntx) {
+  if (cntx.stats != nullptr) {
+    *cntx.stats = ConvexHullStats{};
+  }
+}
 
-  auto initial_tethraedron = points.getInitialTethraedron();
-  hull::Hull hull(points.points[initial_tethraedron[0]],
-                  points.points[initial_tethraedron[1]],
-                  points.points[initial_tethraedron[2]],
-                  points.points[initial_tethraedron[3]], mapper);
+// false when, according to the approximation, the hull is already close
+// enough to the cloud, or adding one more vertex would exceed the budgets
+bool is_worth_adding(const std::optional<Approximation> &approximation,
+                     const Mesh &mesh, double distance, double min_distance) {
+  if (!approximation.has_value()) {
+    return true;
+  }
+  if (distance < min_distance) {
+    return false;
+  }
+  if ((approximation->max_vertices != 0) &&
+      (approximation->max_vertices <= mesh.verticesSize())) {
+    return false;
+  }
+  // a closed triangulated surface made of V vertices has 2 * V - 4 facets:
+  // each new vertex adds at most 2 facets
+  return (approximation->max_facets == 0) ||
+         (mesh.size() + 2 <= approximation->max_facets);
+}
 
-  indices_map.emplace(0, initial_tethraedron[0]);
-  indices_map.emplace(1, initial_tethraedron[1]);
-  indices_map.emplace(2, initial_tethraedron[2]);
-  indices_map.emplace(3, initial_tethraedron[3]);
+// true when the computation was cancelled or its deadline is passed
+bool is_interrupted(const ConvexHullContext &cntx) {
+  if ((cntx.cancellation != nullptr) && cntx.cancellation->isCancelled()) {
+    return true;
+  }
+  return cntx.deadline.has_value() &&
+         (cntx.deadline.value() <= std::chrono::steady_clock::now());
+}
 
-  std::atomic_bool life = true;
-  auto pool_size = get_pool_size(cntx.thread_pool_size);
-#pragma omp parallel num_threads(pool_size)
-  {
-    auto th_id = omp_get_thread_num();
-    if (0 == th_id) {
-      for (const auto index : initial_tethraedron) {
-        points.closeVertex(index);
+// Quick Hull iterations, going on until no open vertex is left outside the
+// hull, the maximum number of iterations is reached, the approximation is
+// good enough or the computation is interrupted. Each iteration adds a batch
+// of vertices to the hull, before updating the outside sets of the new
+// facets.
+template <typename Scalar>
+void expand_(Mesh &mesh, PointCloud<Scalar> &points,
+             DistanceMapper<Scalar> &mapper, const ConvexHullContext &cntx) {
+  auto *stats = cntx.stats;
+  mapper.setStats(stats);
+  mapper.setTracer(cntx.tracer);
+  const double min_distance =
+      cntx.approximation.has_value()
+          ? cntx.approximation->relative_tolerance * points.getExtent()
+          : 0;
+  const std::size_t batch_size = std::max<std::size_t>(1, cntx.batch_size);
+  std::vector<typename DistanceMapper<Scalar>::FacetVertexDistance> batch;
+  std::size_t added = 0;
+  for (std::size_t iteration = 0; added <= cntx.max_iterations; ++iteration) {
+    if (is_interrupted(cntx)) {
+      if (stats != nullptr) {
+        stats->interrupted = mapper.getBest() != nullptr;
       }
-#pragma omp barrier
-      mapper.processLastUpdate();
-#pragma omp barrier
-
-      for (std::size_t iteration = 0; iteration <= cntx.max_iterations;
-           ++iteration) {
-        const auto *furthest = mapper.getBest();
-        if (furthest == nullptr) {
+      break;
+    }
+    TraceSpan iteration_span(cntx.tracer, "iteration");
+    iteration_span.setArg("iteration", iteration);
+    {
+      TraceSpan span(cntx.tracer, "best selection");
+      mapper.getBest(std::min(batch_size - 1, cntx.max_iterations - added) + 1,
+                     batch);
+    }
+    if (batch.empty() ||
+        !is_worth_adding(cntx.approximation, mesh, batch.front().distance,
+                         min_distance)) {
+      break;
+    }
+    {
+      TraceSpan span(cntx.tracer, "hull update");
+      span.setArg("vertices", batch.size());
+      ScopedTimer timer(stats, &ConvexHullStats::hull_update_time);
+      // the vertices whose visible region overlaps the one of a previous
+      // vertex of the batch are left to the next iterations
+      mesh.beginBatch();
+      for (const auto &furthest : batch) {
+        if (!is_worth_adding(cntx.approximation, mesh, furthest.distance,
+                             min_distance)) {
           break;
         }
-        indices_map.emplace(hull.getContext().vertices.size(),
-                            furthest->vertex_index);
-        hull.update(points.points[furthest->vertex_index],
-                    const_cast<hull::Facet *>(furthest->facet));
-        points.closeVertex(furthest->vertex_index);
-#pragma omp barrier
-        mapper.processLastUpdate();
-#pragma omp barrier
-      }
-      life.store(false);
-#pragma omp barrier
-    } else {
-      while (true) {
-#pragma omp barrier
-        if (!life.load()) {
-          break;
+        if (!mesh.isInUse(furthest.facet) ||
+            !mesh.update(points.getPoint(furthest.vertex_index),
+                         furthest.vertex_index, furthest.facet)) {
+          continue;
         }
-        mapper.processLastUpdate();
-#pragma omp barrier
+        points.closeVertex(furthest.vertex_index);
+        mapper.collectLastUpdate();
+        ++added;
       }
     }
+    {
+      TraceSpan span(cntx.tracer, "distances update");
+      ScopedTimer timer(stats, &ConvexHullStats::distances_update_time);
+      mapper.processUpdates();
+    }
+    if (stats != nullptr) {
+      stats->iterations = added;
+      ++stats->batches;
+    }
+    if (cntx.progress) {
+      const auto *best = mapper.getBest();
+      cntx.progress(Progress{added, (best == nullptr) ? 0 : best->distance});
+    }
+  }
+  if (stats != nullptr) {
+    stats->max_iterations_reached = mapper.getBest() != nullptr;
+    // not worth delaying an interrupted computation any further
+    stats->approximation_error =
+        (stats->max_iterations_reached && !stats->interrupted)
+            ? mapper.getOutsideDistance()
+            : 0;
+  }
+}
+
+// Builds the initial tethraedron, from which expand_ can start. When
+// coreset_directions is not 0, only the points of the coreset are kept open,
+// instead of culling the interior ones. max_tolerance bounds the tolerance
+// computed from the bounding box of the points.
+template <typename Scalar>
+void initialize_hull_(Mesh &mesh, PointCloud<Scalar> &points,
+                      DistanceMapper<Scalar> &mapper,
+                      const ConvexHullContext &cntx,
+                      std::size_t coreset_directions,
+                      std::optional<Scalar> max_tolerance = std::nullopt) {
+  TraceSpan setup_span(cntx.tracer, "setup");
+  setup_span.setArg("points", points.size());
+  ScopedTimer timer(cntx.stats, &ConvexHullStats::setup_time);
+  mapper.setStats(cntx.stats);
+  mapper.setTracer(cntx.tracer);
+  points.fitBoundingBox(max_tolerance);
+  auto *pool = get_pool(cntx);
+  if (coreset_directions == 0) {
+    TraceSpan span(cntx.tracer, "interior culling");
+    span.setArg("closed",
+                points.cullInteriorPoints(cntx.interior_culling, pool,
+                                          cntx.parallel_threshold));
+  } else {
+    TraceSpan span(cntx.tracer, "coreset");
+    span.setArg("closed", points.keepCoreset(coreset_directions, pool,
+                                             cntx.parallel_threshold));
+  }
+  mapper.reset(pool, cntx.parallel_threshold);
+
+  std::array<std::size_t, 4> initial_tethraedron;
+  {
+    TraceSpan span(cntx.tracer, "initial tethraedron");
+    initial_tethraedron = points.getInitialTethraedron();
+  }
+  mesh.reset({points.getPoint(initial_tethraedron[0]),
+              points.getPoint(initial_tethraedron[1]),
+              points.getPoint(initial_tethraedron[2]),
+              points.getPoint(initial_tethraedron[3])},
+             initial_tethraedron);
+
+  for (const auto index : initial_tethraedron) {
+    points.closeVertex(index);
+  }
+  mapper.processLastUpdate();
+}
+
+// Incidences and normals are extracted by a single pass over the facets,
+// which also gathers them for the mass properties when mass_properties is
+// not null.
+template <typename Scalar>
+void get_results_(const Mesh &mesh, const PointCloud<Scalar> &points,
+                  std::vector<FacetIncidences> &incidences,
+                  std::vector<hull::Coordinate> &normals,
+                  MassAccumulator &mass, MassProperties *mass_properties) {
+  incidences.clear();
+  incidences.reserve(mesh.size());
+  normals.clear();
+  normals.reserve(mesh.size());
+  auto original_index = [&](Mesh::Index vertex) {
+    return points.getOriginalIndex(mesh.getCloudIndex(vertex));
+  };
+  auto precise_point = [&](Mesh::Index vertex) {
+    return points.getPrecisePoint(mesh.getCloudIndex(vertex));
+  };
+  if (mass_properties != nullptr) {
+    // the points are expressed w.r.t. the center of the cloud
+    mass.reset(points.getCenter(), mesh.size());
+  }
+  mesh.forEachFacet([&](Mesh::Index, const Mesh::Facet &facet) {
+    incidences.emplace_back(FacetIncidences{original_index(facet.vertices[0]),
+                                            original_index(facet.vertices[1]),
+                                            original_index(facet.vertices[2])});
+    normals.emplace_back(facet.normal);
+    if (mass_properties != nullptr) {
+      mass.add(precise_point(facet.vertices[0]),
+               precise_point(facet.vertices[1]),
+               precise_point(facet.vertices[2]));
+    }
+  });
+  if (mass_properties != nullptr) {
+    *mass_properties = mass.compute();
   }
+}
 
-  return hull;
+// The points left out of the coreset are compared against the final hull,
+// to measure the approximation error. The ones inside it are discarded by the
+// simd kernels first.
+template <typename Scalar>
+void evaluate_coreset_(Pipeline<Scalar> &pipeline,
+                       const ConvexHullContext &cntx) {
+  TraceSpan span(cntx.tracer, "coreset evaluation");
+  auto &[cloud, mesh, mapper, mass] = pipeline;
+  std::vector<Plane<Scalar>> planes;
+  mesh.forEachFacet([&](Mesh::Index, const Mesh::Facet &facet) {
+    planes.push_back(cloud.getPlane(mesh.getVertex(facet.vertices[0]),
+                                    facet.normal));
+  });
+  const auto outside =
+      cloud.reopenOutside(planes, get_pool(cntx), cntx.parallel_threshold);
+  cntx.stats->approximation_error = mapper.getDistance(outside);
 }
 
-std::vector<FacetIncidences>
-get_indices(const hull::HullContext &ctxt,
-            const HullIndexVSPointCloudIndexMap &indices_map) {
-  std::vector<FacetIncidences> result;
-  result.reserve(ctxt.faces.size());
-  for (const auto &face : ctxt.faces) {
-    result.emplace_back(FacetIncidences{indices_map.at(face->vertexA),
-                                        indices_map.at(face->vertexB),
-                                        indices_map.at(face->vertexC)});
+// the buffers are allocated at the first computation using them
+template <typename T> T &get_or_create(std::unique_ptr<T> &subject) {
+  if (subject == nullptr) {
+    subject = std::make_unique<T>();
   }
-  return result;
+  return *subject;
 }
+} // namespace
 
-std::vector<hull::Coordinate> get_normals(const hull::HullContext &ctxt) {
-  std::vector<hull::Coordinate> result;
-  result.reserve(ctxt.faces.size());
-  for (const auto &face : ctxt.faces) {
-    result.emplace_back(face->normal);
+template <typename Scalar>
+void compute_hull(Pipeline<Scalar> &pipeline,
+                  const BasicPointsView<Scalar> &points,
+                  const ConvexHullContext &cntx,
+                  std::vector<FacetIncidences> &incidences,
+                  std::vector<hull::Coordinate> &normals,
+                  std::optional<Scalar> max_tolerance) {
+  reset_stats(cntx);
+  pipeline.cloud.reset(points, cntx.spatial_sort);
+  const std::size_t coreset_directions =
+      cntx.approximation.has_value() ? cntx.approximation->coreset_directions
+                                     : 0;
+  initialize_hull_(pipeline.mesh, pipeline.cloud, pipeline.mapper, cntx,
+                   coreset_directions, max_tolerance);
+  expand_(pipeline.mesh, pipeline.cloud, pipeline.mapper, cntx);
+  get_results_(pipeline.mesh, pipeline.cloud, incidences, normals,
+               pipeline.mass, cntx.mass_properties);
+  if ((coreset_directions != 0) && (cntx.stats != nullptr)) {
+    evaluate_coreset_(pipeline, cntx);
   }
-  return result;
 }
+
+template void compute_hull<float>(Pipeline<float> &, const PointsView &,
+                                  const ConvexHullContext &,
+                                  std::vector<FacetIncidences> &,
+                                  std::vector<hull::Coordinate> &,
+                                  std::optional<float>);
+template void compute_hull<double>(Pipeline<double> &, const PointsViewD &,
+                                   const ConvexHullContext &,
+                                   std::vector<FacetIncidences> &,
+                                   std::vector<hull::Coordinate> &,
+                                   std::optional<double>);
+
+namespace {
+template <typename Scalar> struct Workspaces {
+  std::unique_ptr<Pipeline<Scalar>> pipeline;
+  std::unique_ptr<DivideAndConquer<Scalar>> divide_and_conquer;
+
+  void compute(const BasicPointsView<Scalar> &points,
+               const ConvexHullContext &cntx,
+               std::vector<FacetIncidences> &incidences,
+               std::vector<hull::Coordinate> &normals) {
+    auto *pool = get_pool(cntx);
+    if ((cntx.parallel_mode == ParallelMode::DIVIDE_AND_CONQUER) &&
+        (pool != nullptr) && (cntx.parallel_threshold <= points.size)) {
+      get_or_create(divide_and_conquer)
+          .compute(points, *pool, cntx, get_or_create(pipeline), incidences,
+                   normals);
+      return;
+    }
+    compute_hull(get_or_create(pipeline), points, cntx, incidences, normals);
+  }
+};
 } // namespace
 
+struct HullEngine::Workspace {
+  Workspaces<float> single_precision;
+  Workspaces<double> double_precision;
+
+  std::vector<FacetIncidences> incidences;
+  std::vector<hull::Coordinate> normals;
+};
+
+HullEngine::HullEngine(const ConvexHullContext &cntx)
+    : context(cntx), workspace(std::make_unique<Workspace>()) {}
+
+HullEngine::~HullEngine() = default;
+
+HullEngine::HullEngine(HullEngine &&) = default;
+HullEngine &HullEngine::operator=(HullEngine &&) = default;
+
+const std::vector<FacetIncidences> &
+HullEngine::compute(const std::vector<hull::Coordinate> &points) {
+  return compute(make_view(points));
+}
+
+const std::vector<FacetIncidences> &
+HullEngine::compute(const PointsView &points) {
+  workspace->single_precision.compute(points, context, workspace->incidences,
+                                      workspace->normals);
+  return workspace->incidences;
+}
+
+const std::vector<FacetIncidences> &
+HullEngine::compute(const PointsViewD &points) {
+  workspace->double_precision.compute(points, context, workspace->incidences,
+                                      workspace->normals);
+  return workspace->incidences;
+}
+
+const std::vector<FacetIncidences> &HullEngine::getIncidences() const {
+  return workspace->incidences;
+}
+
+const std::vector<hull::Coordinate> &HullEngine::getNormals() const {
+  return workspace->normals;
+}
+
+struct IncrementalHull::State {
+  PointCloud<float> cloud;
+  Mesh mesh;
+  DistanceMapper<float> mapper{cloud, mesh};
+  // false until the inserted points span a non null volume
+  bool built = false;
+  std::vector<std::size_t> new_vertices;
+  MassAccumulator mass;
+
+  std::vector<FacetIncidences> incidences;
+  std::vector<hull::Coordinate> normals;
+};
+
+IncrementalHull::IncrementalHull(const ConvexHullContext &cntx)
+    : context(cntx), state(std::make_unique<State>()) {}
+
+IncrementalHull::~IncrementalHull() = default;
+
+IncrementalHull::IncrementalHull(IncrementalHull &&) = default;
+IncrementalHull &IncrementalHull::operator=(IncrementalHull &&) = default;
+
+void IncrementalHull::insert(const std::vector<hull::Coordinate> &points) {
+  insert(make_view(points));
+}
+
+void IncrementalHull::insert(const PointsView &points) {
+  auto &[cloud, mesh, mapper, built, new_vertices, mass, incidences,
+         normals] = *state;
+  reset_stats(context);
+  const std::size_t first_new = cloud.size();
+  cloud.append(points);
+  if (built) {
+    new_vertices.clear();
+    for (std::size_t k = first_new; k < cloud.size(); ++k) {
+      new_vertices.push_back(k);
+    }
+    mapper.setParallelism(get_pool(context), context.parallel_threshold);
+    mapper.setStats(context.stats);
+    mapper.setTracer(context.tracer);
+    {
+      ScopedTimer timer(context.stats, &ConvexHullStats::setup_time);
+      mapper.addVertices(new_vertices);
+    }
+    expand_(mesh, cloud, mapper, context);
+  } else {
+    if (cloud.size() < 4) {
+      return;
+    }
+    try {
+      initialize_hull_(mesh, cloud, mapper, context, 0);
+    } catch (const Error &) {
+      // null volume: try again at the next insert
+      return;
+    }
+    built = true;
+    expand_(mesh, cloud, mapper, context);
+  }
+  get_results_(mesh, cloud, incidences, normals, mass,
+               context.mass_properties);
+}
+
+std::size_t IncrementalHull::size() const { return state->cloud.size(); }
+
+const std::vector<FacetIncidences> &IncrementalHull::getIncidences() const {
+  return state->incidences;
+}
+
+const std::vector<hull::Coordinate> &IncrementalHull::getNormals() const {
+  return state->normals;
+}
+
+PointsView make_view(const std::vector<hull::Coordinate> &points) {
+  static_assert(sizeof(hull::Coordinate) == 3 * sizeof(float),
+                "hull::Coordinate is expected to be made of 3 packed floats");
+  return PointsView{points.empty() ? nullptr : &points.front().x,
+                    points.size(), 3};
+}
+
 std::vector<FacetIncidences>
 convex_hull(const std::vector<hull::Coordinate> &points,
             const ConvexHullContext &cntx) {
-  PointCloud cloud(points);
-  HullIndexVSPointCloudIndexMap indices_map;
-  auto hull = convex_hull_(cloud, cntx, indices_map);
-  return get_indices(hull.getContext(), indices_map);
+  return convex_hull(make_view(points), cntx);
 }
 
 std::vector<FacetIncidences>
 convex_hull(const std::vector<hull::Coordinate> &points,
             std::vector<hull::Coordinate> &convex_hull_normals,
             const ConvexHullContext &cntx) {
-  PointCloud cloud(points);
-  HullIndexVSPointCloudIndexMap indices_map;
-  auto hull = convex_hull_(cloud, cntx, indices_map);
-  convex_hull_normals = get_normals(hull.getContext());
-  return get_indices(hull.getContext(), indices_map);
+  return convex_hull(make_view(points), convex_hull_normals, cntx);
+}
+
+std::vector<FacetIncidences> convex_hull(const PointsView &points,
+                                         const ConvexHullContext &cntx) {
+  HullEngine engine(cntx);
+  return engine.compute(points);
+}
+
+std::vector<FacetIncidences>
+convex_hull(const PointsView &points,
+            std::vector<hull::Coordinate> &convex_hull_normals,
+            const ConvexHullContext &cntx) {
+  HullEngine engine(cntx);
+  auto result = engine.compute(points);
+  convex_hull_normals = engine.getNormals();
+  return result;
+}
+
+std::vector<FacetIncidences> convex_hull(const PointsViewD &points,
+                                         const ConvexHullContext &cntx) {
+  HullEngine engine(cntx);
+  return engine.compute(points);
+}
+
+std::vector<FacetIncidences>
+convex_hull(const PointsViewD &points,
+            std::vector<hull::Coordinate> &convex_hull_normals,
+            const ConvexHullContext &cntx) {
+  HullEngine engine(cntx);
+  auto result = engine.compute(points);
+  convex_hull_normals = engine.getNormals();
+  return result;
 }
 
 } // namespace qh
@@ -0,0 +1,382 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include <QuickHull/Error.h>
+#include <QuickHull/HullQuery.h>
+
+#include "Definitions.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace qh {
+namespace {
+using Index = std::uint32_t;
+
+// the walks start from the vertex (facet) which is the most extreme along
+// the query among the ones precomputed for these directions
+std::vector<hull::Coordinate> seed_directions() {
+  std::vector<hull::Coordinate> axes = {{1, 0, 0},  {0, 1, 0},  {0, 0, 1},
+                                        {1, 1, 1},  {1, 1, -1}, {1, -1, 1},
+                                        {-1, 1, 1}, {1, 1, 0},  {1, -1, 0},
+                                        {1, 0, 1},  {1, 0, -1}, {0, 1, 1},
+                                        {0, 1, -1}};
+  std::vector<hull::Coordinate> result;
+  for (const auto &axis : axes) {
+    result.push_back(axis);
+    result.push_back(hull::Coordinate{-axis.x, -axis.y, -axis.z});
+  }
+  return result;
+}
+
+template <typename Value>
+Index arg_max(const std::vector<Index> &candidates, const Value &value) {
+  Index result = candidates.front();
+  float best = value(result);
+  for (const auto candidate : candidates) {
+    const float candidate_value = value(candidate);
+    if (best < candidate_value) {
+      best = candidate_value;
+      result = candidate;
+    }
+  }
+  return result;
+}
+
+// points are converted to structure of arrays one block at a time, while
+// the block is still in cache
+static constexpr std::size_t CONTAINMENT_BLOCK_SIZE = 1024;
+} // namespace
+
+struct HullQuery::Impl {
+  // sorted by position in the cloud
+  std::vector<std::size_t> cloud_indices;
+  std::vector<hull::Coordinate> vertices;
+  // the vertices linked by an edge to the k-th one are
+  // adjacency[adjacency_begin[k], adjacency_begin[k + 1])
+  std::vector<Index> adjacency_begin;
+  std::vector<Index> adjacency;
+
+  std::vector<Plane<float>> planes;
+  // neighbours[f][k] shares the k-th edge of the f-th facet
+  std::vector<std::array<Index, 3>> neighbours;
+  // the centroid of the vertices, and its distance from the plane of each
+  // facet
+  hull::Coordinate inner_point;
+  std::vector<float> depths;
+
+  float tolerance;
+  std::vector<Index> seed_vertices;
+  std::vector<Index> seed_facets;
+
+  Impl(const PointsView &points, const std::vector<FacetIncidences> &incidences,
+       const std::vector<hull::Coordinate> &normals);
+
+  Index localIndex(std::size_t cloud_index) const {
+    auto it = std::lower_bound(cloud_indices.begin(), cloud_indices.end(),
+                               cloud_index);
+    if ((it == cloud_indices.end()) || (*it != cloud_index)) {
+      return std::numeric_limits<Index>::max();
+    }
+    return static_cast<Index>(it - cloud_indices.begin());
+  }
+
+  float signedDistance(const hull::Coordinate &point, Index facet) const {
+    const auto &plane = planes[facet];
+    return point.x * plane.normal.x + point.y * plane.normal.y +
+           point.z * plane.normal.z - plane.offset;
+  }
+
+  std::size_t support(const hull::Coordinate &direction, Index start) const;
+
+  // the facet maximizing the distance of point from its plane, relative to
+  // the depth of the inner point
+  Index mostVisible(const hull::Coordinate &point) const;
+};
+
+HullQuery::Impl::Impl(const PointsView &points,
+                      const std::vector<FacetIncidences> &incidences,
+                      const std::vector<hull::Coordinate> &normals) {
+  if (incidences.size() != normals.size()) {
+    throw Error{"The incidences and the normals should have the same size"};
+  }
+  if (incidences.size() < 4) {
+    throw Error{"A closed surface should have at least 4 facets"};
+  }
+  for (const auto &facet : incidences) {
+    for (const auto vertex : facet) {
+      if (points.size <= vertex) {
+        throw Error{"The incidences refer to points not in the cloud"};
+      }
+      cloud_indices.push_back(vertex);
+    }
+  }
+  std::sort(cloud_indices.begin(), cloud_indices.end());
+  cloud_indices.erase(std::unique(cloud_indices.begin(), cloud_indices.end()),
+                      cloud_indices.end());
+  inner_point = hull::Coordinate{0, 0, 0};
+  for (const auto index : cloud_indices) {
+    const float *data = points.data + index * points.stride;
+    vertices.emplace_back(hull::Coordinate{data[0], data[1], data[2]});
+    inner_point.x += data[0];
+    inner_point.y += data[1];
+    inner_point.z += data[2];
+  }
+  hull::Coordinate min = vertices.front(), max = vertices.front();
+  for (const auto &vertex : vertices) {
+    min = hull::Coordinate{std::min(min.x, vertex.x), std::min(min.y, vertex.y),
+                           std::min(min.z, vertex.z)};
+    max = hull::Coordinate{std::max(max.x, vertex.x), std::max(max.y, vertex.y),
+                           std::max(max.z, vertex.z)};
+  }
+  const float vertices_size = static_cast<float>(vertices.size());
+  inner_point.x /= vertices_size;
+  inner_point.y /= vertices_size;
+  inner_point.z /= vertices_size;
+  tolerance = GeometricTolerance<float>::get(
+      std::max({std::abs(min.x), std::abs(max.x), std::abs(min.y),
+                std::abs(max.y), std::abs(min.z), std::abs(max.z)}),
+      std::max({max.x - min.x, max.y - min.y, max.z - min.z}));
+
+  // each directed edge is mapped to the facet having it
+  auto edge_key = [](Index from, Index to) {
+    return (static_cast<std::uint64_t>(from) << 32) | to;
+  };
+  std::vector<std::array<Index, 3>> facets;
+  std::unordered_map<std::uint64_t, Index> edges;
+  for (std::size_t f = 0; f < incidences.size(); ++f) {
+    std::array<Index, 3> facet;
+    for (std::size_t k = 0; k < 3; ++k) {
+      facet[k] = localIndex(incidences[f][k]);
+    }
+    const auto &normal = normals[f];
+    planes.push_back(
+        Plane<float>{Vector3<float>{normal.x, normal.y, normal.z},
+                     hull::dot(normal, vertices[facet[0]])});
+    depths.push_back(planes.back().offset - hull::dot(normal, inner_point));
+    for (std::size_t k = 0; k < 3; ++k) {
+      if (!edges.emplace(edge_key(facet[k], facet[(k + 1) % 3]),
+                         static_cast<Index>(f))
+               .second) {
+        throw Error{"The incidences don't describe a closed surface"};
+      }
+    }
+    facets.push_back(facet);
+  }
+
+  adjacency_begin.assign(vertices.size() + 1, 0);
+  for (const auto &facet : facets) {
+    std::array<Index, 3> neighbour;
+    for (std::size_t k = 0; k < 3; ++k) {
+      auto opposite = edges.find(edge_key(facet[(k + 1) % 3], facet[k]));
+      if (opposite == edges.end()) {
+        throw Error{"The incidences don't describe a closed surface"};
+      }
+      neighbour[k] = opposite->second;
+      ++adjacency_begin[facet[k] + 1];
+    }
+    neighbours.push_back(neighbour);
+  }
+  // each edge is found once from each of its vertices, as the facets on its
+  // two sides traverse it in opposite directions
+  for (std::size_t v = 0; v < vertices.size(); ++v) {
+    adjacency_begin[v + 1] += adjacency_begin[v];
+  }
+  adjacency.resize(adjacency_begin.back());
+  std::vector<Index> filled(adjacency_begin.begin(), adjacency_begin.end() - 1);
+  for (const auto &facet : facets) {
+    for (std::size_t k = 0; k < 3; ++k) {
+      adjacency[filled[facet[k]]++] = facet[(k + 1) % 3];
+    }
+  }
+
+  for (const auto &direction : seed_directions()) {
+    Index vertex = 0, facet = 0;
+    for (Index v = 1; v < vertices.size(); ++v) {
+      if (hull::dot(vertices[vertex], direction) <
+          hull::dot(vertices[v], direction)) {
+        vertex = v;
+      }
+    }
+    for (Index f = 1; f < normals.size(); ++f) {
+      if (hull::dot(normals[facet], direction) <
+          hull::dot(normals[f], direction)) {
+        facet = f;
+      }
+    }
+    seed_vertices.push_back(vertex);
+    seed_facets.push_back(facet);
+  }
+  for (auto *seeds : {&seed_vertices, &seed_facets}) {
+    std::sort(seeds->begin(), seeds->end());
+    seeds->erase(std::unique(seeds->begin(), seeds->end()), seeds->end());
+  }
+}
+
+std::size_t HullQuery::Impl::support(const hull::Coordinate &direction,
+                                     Index start) const {
+  // steepest ascent: a vertex which is not the farthest one always has a
+  // neighbour farther than itself
+  Index current = start;
+  float best = hull::dot(vertices[current], direction);
+  bool moved = true;
+  while (moved) {
+    moved = false;
+    const Index begin = adjacency_begin[current],
+                end = adjacency_begin[current + 1];
+    for (Index k = begin; k < end; ++k) {
+      const float candidate = hull::dot(vertices[adjacency[k]], direction);
+      if (best < candidate) {
+        best = candidate;
+        current = adjacency[k];
+        moved = true;
+      }
+    }
+  }
+  return cloud_indices[current];
+}
+
+Index HullQuery::Impl::mostVisible(const hull::Coordinate &point) const {
+  // In the polar dual of the hull w.r.t. the inner point, the facets are
+  // vertices, adjacent when the facets are neighbours, and the relative
+  // distance is a linear function of them: a local maximum is the global one.
+  // Ties, as for coplanar facets, are crossed without visiting a facet twice.
+  hull::Coordinate direction;
+  hull::diff(direction, point, inner_point);
+  auto relative_distance = [&](Index facet) {
+    const auto &normal = planes[facet].normal;
+    return (direction.x * normal.x + direction.y * normal.y +
+            direction.z * normal.z) /
+           depths[facet];
+  };
+  Index current = arg_max(seed_facets, relative_distance);
+  float best = relative_distance(current);
+  // allocated only when meeting ties
+  std::vector<Index> plateau;
+  while (true) {
+    Index next = std::numeric_limits<Index>::max();
+    float next_distance = best;
+    for (const auto neighbour : neighbours[current]) {
+      const float candidate = relative_distance(neighbour);
+      if (next_distance < candidate) {
+        next = neighbour;
+        next_distance = candidate;
+      } else if ((candidate == best) && (next_distance == best) &&
+                 (std::find(plateau.begin(), plateau.end(), neighbour) ==
+                  plateau.end())) {
+        next = neighbour;
+      }
+    }
+    if (next == std::numeric_limits<Index>::max()) {
+      return current;
+    }
+    if (best < next_distance) {
+      plateau.clear();
+    } else {
+      plateau.push_back(current);
+    }
+    best = next_distance;
+    current = next;
+  }
+}
+
+HullQuery::HullQuery(const std::vector<hull::Coordinate> &points,
+                     const std::vector<FacetIncidences> &incidences,
+                     const std::vector<hull::Coordinate> &normals)
+    : HullQuery(make_view(points), incidences, normals) {}
+
+HullQuery::HullQuery(const PointsView &points,
+                     const std::vector<FacetIncidences> &incidences,
+                     const std::vector<hull::Coordinate> &normals)
+    : impl(std::make_unique<Impl>(points, incidences, normals)) {}
+
+HullQuery::~HullQuery() = default;
+
+HullQuery::HullQuery(HullQuery &&) = default;
+HullQuery &HullQuery::operator=(HullQuery &&) = default;
+
+std::size_t HullQuery::support(const hull::Coordinate &direction) const {
+  return impl->support(
+      direction, arg_max(impl->seed_vertices, [&](Index vertex) {
+        return hull::dot(impl->vertices[vertex], direction);
+      }));
+}
+
+std::size_t HullQuery::support(const hull::Coordinate &direction,
+                               std::size_t hint) const {
+  const Index start = impl->localIndex(hint);
+  if (start == std::numeric_limits<Index>::max()) {
+    return support(direction);
+  }
+  return impl->support(direction, start);
+}
+
+bool HullQuery::contains(const hull::Coordinate &point) const {
+  const float distance =
+      impl->signedDistance(point, impl->mostVisible(point));
+  if (distance <= 0) {
+    // not even the most visible facet sees the point
+    return true;
+  }
+  if (impl->tolerance < distance) {
+    return false;
+  }
+  // seen within the tolerance, while another facet could see it beyond
+  for (Index f = 0; f < impl->planes.size(); ++f) {
+    if (impl->tolerance < impl->signedDistance(point, f)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HullQuery::contains(const PointsView &points,
+                         std::vector<std::uint8_t> &result) const {
+  const auto &kernels = get_kernels<float>();
+  result.resize(points.size);
+  std::vector<float> x, y, z;
+  for (std::size_t block = 0; block < points.size;
+       block += CONTAINMENT_BLOCK_SIZE) {
+    const std::size_t block_size =
+        std::min(CONTAINMENT_BLOCK_SIZE, points.size - block);
+    x.resize(block_size);
+    y.resize(block_size);
+    z.resize(block_size);
+    const float *point = points.data + block * points.stride;
+    for (std::size_t k = 0; k < block_size; ++k, point += points.stride) {
+      x[k] = point[0];
+      y[k] = point[1];
+      z[k] = point[2];
+    }
+    // the kernel zeroes the flags of the points whose distance from all the
+    // planes is lower than minus the passed tolerance
+    std::uint8_t *flags = result.data() + block;
+    std::fill(flags, flags + block_size, 1);
+    kernels.close_inside_polytope(
+        CoordinatesSoA<float>{x.data(), y.data(), z.data()}, block_size,
+        impl->planes.data(), impl->planes.size(), Vector3<float>{0, 0, 0},
+        -impl->tolerance, flags);
+    for (std::size_t k = 0; k < block_size; ++k) {
+      flags[k] = 1 - flags[k];
+    }
+  }
+}
+
+void HullQuery::contains(const std::vector<hull::Coordinate> &points,
+                         std::vector<std::uint8_t> &result) const {
+  contains(make_view(points), result);
+}
+
+std::size_t HullQuery::verticesSize() const { return impl->vertices.size(); }
+
+std::size_t HullQuery::facetsSize() const { return impl->planes.size(); }
+
+float HullQuery::getTolerance() const { return impl->tolerance; }
+} // namespace qh
@@ -0,0 +1,149 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace qh {
+/** @brief Binary max heap storing the elements in a contiguous buffer.
+ * Each element is associated to a key, i.e. a small integer like the index
+ * of the facet it refers to. The position of each key inside the heap is
+ * tracked, allowing to remove any element in O(log n) without searching it.
+ */
+template <typename T> class IndexedHeap {
+public:
+  static constexpr std::size_t NOT_IN_HEAP =
+      std::numeric_limits<std::size_t>::max();
+
+  IndexedHeap() = default;
+
+  bool empty() const { return nodes.empty(); }
+  std::size_t size() const { return nodes.size(); }
+
+  const T &top() const { return nodes.front().value; }
+
+  // The count greatest values, in decreasing order. The tree is explored best
+  // first, in O(count log count) whatever the size of the heap.
+  void getGreatest(std::size_t count, std::vector<T> &recipient) const {
+    recipient.clear();
+    frontier.clear();
+    auto is_less = [this](std::size_t a, std::size_t b) {
+      return nodes[a].value < nodes[b].value;
+    };
+    if (!nodes.empty()) {
+      frontier.push_back(0);
+    }
+    while (!frontier.empty() && (recipient.size() < count)) {
+      std::pop_heap(frontier.begin(), frontier.end(), is_less);
+      const std::size_t position = frontier.back();
+      frontier.pop_back();
+      recipient.push_back(nodes[position].value);
+      for (std::size_t child = 2 * position + 1;
+           (child <= 2 * position + 2) && (child < nodes.size()); ++child) {
+        frontier.push_back(child);
+        std::push_heap(frontier.begin(), frontier.end(), is_less);
+      }
+    }
+  }
+
+  void reserve(std::size_t size) { nodes.reserve(size); }
+
+  bool contains(std::size_t key) const {
+    return (key < positions.size()) && (positions[key] != NOT_IN_HEAP);
+  }
+
+  // key should not be already in the heap
+  void push(const T &value, std::size_t key) {
+    if (positions.size() <= key) {
+      positions.resize(key + 1, NOT_IN_HEAP);
+    }
+    positions[key] = nodes.size();
+    nodes.push_back(Node{value, key});
+    siftUp(nodes.size() - 1);
+  }
+
+  // does nothing when key is not in the heap
+  void erase(std::size_t key) {
+    if (!contains(key)) {
+      return;
+    }
+    std::size_t position = positions[key];
+    positions[key] = NOT_IN_HEAP;
+    std::size_t last = nodes.size() - 1;
+    if (position != last) {
+      nodes[position] = std::move(nodes[last]);
+      positions[nodes[position].key] = position;
+      nodes.pop_back();
+      siftDown(siftUp(position));
+    } else {
+      nodes.pop_back();
+    }
+  }
+
+  void clear() {
+    for (const auto &node : nodes) {
+      positions[node.key] = NOT_IN_HEAP;
+    }
+    nodes.clear();
+  }
+
+private:
+  struct Node {
+    T value;
+    std::size_t key;
+  };
+
+  void swap(std::size_t a, std::size_t b) {
+    std::swap(nodes[a], nodes[b]);
+    positions[nodes[a].key] = a;
+    positions[nodes[b].key] = b;
+  }
+
+  std::size_t siftUp(std::size_t position) {
+    while (position != 0) {
+      std::size_t parent = (position - 1) / 2;
+      if (!(nodes[parent].value < nodes[position].value)) {
+        break;
+      }
+      swap(parent, position);
+      position = parent;
+    }
+    return position;
+  }
+
+  void siftDown(std::size_t position) {
+    const std::size_t size = nodes.size();
+    while (true) {
+      std::size_t largest = position;
+      std::size_t left = 2 * position + 1;
+      std::size_t right = left + 1;
+      if ((left < size) && (nodes[largest].value < nodes[left].value)) {
+        largest = left;
+      }
+      if ((right < size) && (nodes[largest].value < nodes[right].value)) {
+        largest = right;
+      }
+      if (largest == position) {
+        return;
+      }
+      swap(largest, position);
+      position = largest;
+    }
+  }
+
+  std::vector<Node> nodes;
+  // position in nodes of each key
+  std::vector<std::size_t> positions;
+  // buffer of getGreatest: the positions of the nodes whose parent was
+  // already taken
+  mutable std::vector<std::size_t> frontier;
+};
+} // namespace qh
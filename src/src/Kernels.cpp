@@ -0,0 +1,1168 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define QH_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace qh {
+namespace {
+////////////////////////////////////////////////////////////////////////////
+// scalar
+////////////////////////////////////////////////////////////////////////////
+
+template <typename Scalar>
+ArgMax<Scalar> farthest_in_subset_scalar(const CoordinatesSoA<Scalar> &cloud,
+                                         const std::size_t *subset,
+                                         std::size_t subset_size,
+                                         const Vector3<Scalar> &point,
+                                         const Vector3<Scalar> &normal,
+                                         Scalar threshold) {
+  ArgMax<Scalar> result{0, threshold};
+  for (std::size_t k = 0; k < subset_size; ++k) {
+    const std::size_t index = subset[k];
+    Scalar distance = (cloud.x[index] - point.x) * normal.x +
+                      (cloud.y[index] - point.y) * normal.y +
+                      (cloud.z[index] - point.z) * normal.z;
+    if (result.value < distance) {
+      result.value = distance;
+      result.index = index;
+    }
+  }
+  return result;
+}
+
+template <typename Scalar>
+ArgMax<Scalar>
+farthest_in_cloud_scalar(const CoordinatesSoA<Scalar> &cloud,
+                         std::size_t cloud_size,
+                         const QuadraticDistance<Scalar> &distance,
+                         Scalar threshold) {
+  ArgMax<Scalar> result{0, threshold};
+  for (std::size_t k = 0; k < cloud_size; ++k) {
+    Scalar dx = cloud.x[k] - distance.origin.x;
+    Scalar dy = cloud.y[k] - distance.origin.y;
+    Scalar dz = cloud.z[k] - distance.origin.z;
+    Scalar projection = dx * distance.direction.x +
+                        dy * distance.direction.y + dz * distance.direction.z;
+    Scalar value = distance.norm_coeff * (dx * dx + dy * dy + dz * dz) +
+                   distance.direction_coeff * projection * projection;
+    if (result.value < value) {
+      result.value = value;
+      result.index = k;
+    }
+  }
+  return result;
+}
+
+template <typename Scalar>
+ArgMax<Scalar>
+farthest_along_direction_scalar(const CoordinatesSoA<Scalar> &cloud,
+                                std::size_t cloud_size,
+                                const Vector3<Scalar> &direction) {
+  ArgMax<Scalar> result{0, std::numeric_limits<Scalar>::lowest()};
+  for (std::size_t k = 0; k < cloud_size; ++k) {
+    Scalar value = cloud.x[k] * direction.x + cloud.y[k] * direction.y +
+                   cloud.z[k] * direction.z;
+    if (result.value < value) {
+      result.value = value;
+      result.index = k;
+    }
+  }
+  return result;
+}
+
+template <typename Scalar>
+std::size_t close_inside_polytope_scalar(const CoordinatesSoA<Scalar> &cloud,
+                                         std::size_t cloud_size,
+                                         const Plane<Scalar> *planes,
+                                         std::size_t planes_size,
+                                         const Vector3<Scalar> &origin,
+                                         Scalar tolerance,
+                                         std::uint8_t *open_set) {
+  std::size_t closed = 0;
+  for (std::size_t k = 0; k < cloud_size; ++k) {
+    const Scalar x = cloud.x[k] - origin.x;
+    const Scalar y = cloud.y[k] - origin.y;
+    const Scalar z = cloud.z[k] - origin.z;
+    Scalar distance = std::numeric_limits<Scalar>::lowest();
+    for (std::size_t p = 0; p < planes_size; ++p) {
+      const auto &plane = planes[p];
+      distance = std::max(distance, x * plane.normal.x + y * plane.normal.y +
+                                        z * plane.normal.z - plane.offset);
+    }
+    if ((distance < -tolerance) && (open_set[k] != 0)) {
+      open_set[k] = 0;
+      ++closed;
+    }
+  }
+  return closed;
+}
+
+// the pairs of coordinates of MassSums::second
+constexpr std::size_t SECOND_ORDER_PAIRS[6][2] = {{0, 0}, {1, 1}, {2, 2},
+                                                   {0, 1}, {1, 2}, {2, 0}};
+
+TrianglesSoA advance(const TrianglesSoA &triangles, std::size_t offset) {
+  auto advance_vertex = [offset](const CoordinatesSoA<double> &vertex) {
+    return CoordinatesSoA<double>{vertex.x + offset, vertex.y + offset,
+                                  vertex.z + offset};
+  };
+  return TrianglesSoA{advance_vertex(triangles.a), advance_vertex(triangles.b),
+                      advance_vertex(triangles.c)};
+}
+
+void accumulate_mass_scalar(const TrianglesSoA &triangles, std::size_t size,
+                            MassSums &sums) {
+  for (std::size_t k = 0; k < size; ++k) {
+    const double a[3] = {triangles.a.x[k], triangles.a.y[k],
+                         triangles.a.z[k]};
+    const double b[3] = {triangles.b.x[k], triangles.b.y[k],
+                         triangles.b.z[k]};
+    const double c[3] = {triangles.c.x[k], triangles.c.y[k],
+                         triangles.c.z[k]};
+    const double det = a[0] * (b[1] * c[2] - b[2] * c[1]) +
+                       a[1] * (b[2] * c[0] - b[0] * c[2]) +
+                       a[2] * (b[0] * c[1] - b[1] * c[0]);
+    double u[3], v[3], s[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+      u[i] = b[i] - a[i];
+      v[i] = c[i] - a[i];
+      s[i] = a[i] + b[i] + c[i];
+    }
+    const double nx = u[1] * v[2] - u[2] * v[1];
+    const double ny = u[2] * v[0] - u[0] * v[2];
+    const double nz = u[0] * v[1] - u[1] * v[0];
+    sums.area += std::sqrt(nx * nx + ny * ny + nz * nz);
+    sums.volume += det;
+    for (std::size_t i = 0; i < 3; ++i) {
+      sums.first[i] += det * s[i];
+    }
+    for (std::size_t p = 0; p < 6; ++p) {
+      const std::size_t i = SECOND_ORDER_PAIRS[p][0];
+      const std::size_t j = SECOND_ORDER_PAIRS[p][1];
+      sums.second[p] +=
+          det * (a[i] * a[j] + b[i] * b[j] + c[i] * c[j] + s[i] * s[j]);
+    }
+  }
+}
+
+#ifdef QH_SIMD_DISPATCH
+// Lanes are reduced picking the greatest value, and the smallest position
+// among the equal ones, in order to get the same result of the scalar
+// versions.
+template <std::size_t Lanes, typename Scalar, typename Position>
+void reduce_lanes(ArgMax<Scalar> &result, const Scalar *values,
+                  const Position *positions) {
+  Position best_position = -1;
+  for (std::size_t l = 0; l < Lanes; ++l) {
+    if (positions[l] < 0) {
+      continue;
+    }
+    if ((result.value < values[l]) ||
+        ((result.value == values[l]) && (positions[l] < best_position))) {
+      result.value = values[l];
+      result.index = static_cast<std::size_t>(positions[l]);
+      best_position = positions[l];
+    }
+  }
+}
+
+constexpr std::size_t MAX_SIMD_SIZE =
+    static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+
+////////////////////////////////////////////////////////////////////////////
+// AVX2, single precision
+////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2,fma"))) __m256
+gather_avx2(const float *base, const std::size_t *indices) {
+  __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices));
+  __m256i hi =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices + 4));
+  return _mm256_set_m128(_mm256_i64gather_ps(base, hi, 4),
+                         _mm256_i64gather_ps(base, lo, 4));
+}
+
+__attribute__((target("avx2,fma"))) ArgMax<float>
+farthest_in_subset_avx2(const CoordinatesSoA<float> &cloud,
+                        const std::size_t *subset, std::size_t subset_size,
+                        const Vector3<float> &point,
+                        const Vector3<float> &normal, float threshold) {
+  if (MAX_SIMD_SIZE < subset_size) {
+    return farthest_in_subset_scalar(cloud, subset, subset_size, point, normal,
+                                     threshold);
+  }
+  const __m256 px = _mm256_set1_ps(point.x);
+  const __m256 py = _mm256_set1_ps(point.y);
+  const __m256 pz = _mm256_set1_ps(point.z);
+  const __m256 nx = _mm256_set1_ps(normal.x);
+  const __m256 ny = _mm256_set1_ps(normal.y);
+  const __m256 nz = _mm256_set1_ps(normal.z);
+  __m256 best = _mm256_set1_ps(threshold);
+  __m256i best_position = _mm256_set1_epi32(-1);
+  __m256i position = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i step = _mm256_set1_epi32(8);
+
+  std::size_t k = 0;
+  for (; k + 8 <= subset_size; k += 8) {
+    __m256 x = _mm256_sub_ps(gather_avx2(cloud.x, subset + k), px);
+    __m256 y = _mm256_sub_ps(gather_avx2(cloud.y, subset + k), py);
+    __m256 z = _mm256_sub_ps(gather_avx2(cloud.z, subset + k), pz);
+    __m256 distance =
+        _mm256_fmadd_ps(z, nz, _mm256_fmadd_ps(y, ny, _mm256_mul_ps(x, nx)));
+    __m256 mask = _mm256_cmp_ps(distance, best, _CMP_GT_OQ);
+    best = _mm256_blendv_ps(best, distance, mask);
+    best_position = _mm256_castps_si256(
+        _mm256_blendv_ps(_mm256_castsi256_ps(best_position),
+                         _mm256_castsi256_ps(position), mask));
+    position = _mm256_add_epi32(position, step);
+  }
+
+  alignas(32) float values[8];
+  alignas(32) std::int32_t positions[8];
+  _mm256_store_ps(values, best);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(positions), best_position);
+  ArgMax<float> result{0, threshold};
+  reduce_lanes<8>(result, values, positions);
+  if (result.value != threshold) {
+    result.index = subset[result.index];
+  }
+
+  ArgMax<float> tail = farthest_in_subset_scalar(
+      cloud, subset + k, subset_size - k, point, normal, result.value);
+  return (tail.value == result.value) ? result : tail;
+}
+
+__attribute__((target("avx2,fma"))) ArgMax<float>
+farthest_in_cloud_avx2(const CoordinatesSoA<float> &cloud,
+                       std::size_t cloud_size,
+                       const QuadraticDistance<float> &distance,
+                       float threshold) {
+  if (MAX_SIMD_SIZE < cloud_size) {
+    return farthest_in_cloud_scalar(cloud, cloud_size, distance, threshold);
+  }
+  const __m256 ox = _mm256_set1_ps(distance.origin.x);
+  const __m256 oy = _mm256_set1_ps(distance.origin.y);
+  const __m256 oz = _mm256_set1_ps(distance.origin.z);
+  const __m256 ux = _mm256_set1_ps(distance.direction.x);
+  const __m256 uy = _mm256_set1_ps(distance.direction.y);
+  const __m256 uz = _mm256_set1_ps(distance.direction.z);
+  const __m256 norm_coeff = _mm256_set1_ps(distance.norm_coeff);
+  const __m256 direction_coeff = _mm256_set1_ps(distance.direction_coeff);
+  __m256 best = _mm256_set1_ps(threshold);
+  __m256i best_position = _mm256_set1_epi32(-1);
+  __m256i position = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i step = _mm256_set1_epi32(8);
+
+  std::size_t k = 0;
+  for (; k + 8 <= cloud_size; k += 8) {
+    __m256 x = _mm256_sub_ps(_mm256_loadu_ps(cloud.x + k), ox);
+    __m256 y = _mm256_sub_ps(_mm256_loadu_ps(cloud.y + k), oy);
+    __m256 z = _mm256_sub_ps(_mm256_loadu_ps(cloud.z + k), oz);
+    __m256 norm =
+        _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+    __m256 projection =
+        _mm256_fmadd_ps(z, uz, _mm256_fmadd_ps(y, uy, _mm256_mul_ps(x, ux)));
+    __m256 value = _mm256_fmadd_ps(
+        direction_coeff, _mm256_mul_ps(projection, projection),
+        _mm256_mul_ps(norm_coeff, norm));
+    __m256 mask = _mm256_cmp_ps(value, best, _CMP_GT_OQ);
+    best = _mm256_blendv_ps(best, value, mask);
+    best_position = _mm256_castps_si256(
+        _mm256_blendv_ps(_mm256_castsi256_ps(best_position),
+                         _mm256_castsi256_ps(position), mask));
+    position = _mm256_add_epi32(position, step);
+  }
+
+  alignas(32) float values[8];
+  alignas(32) std::int32_t positions[8];
+  _mm256_store_ps(values, best);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(positions), best_position);
+  ArgMax<float> result{0, threshold};
+  reduce_lanes<8>(result, values, positions);
+
+  CoordinatesSoA<float> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  ArgMax<float> tail = farthest_in_cloud_scalar(tail_cloud, cloud_size - k,
+                                                distance, result.value);
+  if (tail.value == result.value) {
+    return result;
+  }
+  tail.index += k;
+  return tail;
+}
+
+__attribute__((target("avx2,fma"))) ArgMax<float>
+farthest_along_direction_avx2(const CoordinatesSoA<float> &cloud,
+                              std::size_t cloud_size,
+                              const Vector3<float> &direction) {
+  if (MAX_SIMD_SIZE < cloud_size) {
+    return farthest_along_direction_scalar(cloud, cloud_size, direction);
+  }
+  const __m256 ux = _mm256_set1_ps(direction.x);
+  const __m256 uy = _mm256_set1_ps(direction.y);
+  const __m256 uz = _mm256_set1_ps(direction.z);
+  __m256 best = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+  __m256i best_position = _mm256_set1_epi32(-1);
+  __m256i position = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i step = _mm256_set1_epi32(8);
+
+  std::size_t k = 0;
+  for (; k + 8 <= cloud_size; k += 8) {
+    __m256 value = _mm256_fmadd_ps(
+        _mm256_loadu_ps(cloud.z + k), uz,
+        _mm256_fmadd_ps(_mm256_loadu_ps(cloud.y + k), uy,
+                        _mm256_mul_ps(_mm256_loadu_ps(cloud.x + k), ux)));
+    __m256 mask = _mm256_cmp_ps(value, best, _CMP_GT_OQ);
+    best = _mm256_blendv_ps(best, value, mask);
+    best_position = _mm256_castps_si256(
+        _mm256_blendv_ps(_mm256_castsi256_ps(best_position),
+                         _mm256_castsi256_ps(position), mask));
+    position = _mm256_add_epi32(position, step);
+  }
+
+  alignas(32) float values[8];
+  alignas(32) std::int32_t positions[8];
+  _mm256_store_ps(values, best);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(positions), best_position);
+  ArgMax<float> result{0, std::numeric_limits<float>::lowest()};
+  reduce_lanes<8>(result, values, positions);
+
+  CoordinatesSoA<float> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  ArgMax<float> tail =
+      farthest_along_direction_scalar(tail_cloud, cloud_size - k, direction);
+  if (!(result.value < tail.value)) {
+    return result;
+  }
+  tail.index += k;
+  return tail;
+}
+
+__attribute__((target("avx2,fma"))) std::size_t
+close_inside_polytope_avx2(const CoordinatesSoA<float> &cloud,
+                           std::size_t cloud_size, const Plane<float> *planes,
+                           std::size_t planes_size,
+                           const Vector3<float> &origin, float tolerance,
+                           std::uint8_t *open_set) {
+  const __m256 threshold = _mm256_set1_ps(-tolerance);
+  const __m256 origin_x = _mm256_set1_ps(origin.x);
+  const __m256 origin_y = _mm256_set1_ps(origin.y);
+  const __m256 origin_z = _mm256_set1_ps(origin.z);
+  std::size_t closed = 0;
+  std::size_t k = 0;
+  for (; k + 8 <= cloud_size; k += 8) {
+    const __m256 x = _mm256_sub_ps(_mm256_loadu_ps(cloud.x + k), origin_x);
+    const __m256 y = _mm256_sub_ps(_mm256_loadu_ps(cloud.y + k), origin_y);
+    const __m256 z = _mm256_sub_ps(_mm256_loadu_ps(cloud.z + k), origin_z);
+    __m256 distance = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+    for (std::size_t p = 0; p < planes_size; ++p) {
+      const auto &plane = planes[p];
+      __m256 value = _mm256_fmadd_ps(
+          z, _mm256_set1_ps(plane.normal.z),
+          _mm256_fmadd_ps(
+              y, _mm256_set1_ps(plane.normal.y),
+              _mm256_fmsub_ps(x, _mm256_set1_ps(plane.normal.x),
+                              _mm256_set1_ps(plane.offset))));
+      distance = _mm256_max_ps(distance, value);
+    }
+    int mask =
+        _mm256_movemask_ps(_mm256_cmp_ps(distance, threshold, _CMP_LT_OQ));
+    for (std::size_t l = 0; mask != 0; ++l, mask >>= 1) {
+      if ((mask & 1) && (open_set[k + l] != 0)) {
+        open_set[k + l] = 0;
+        ++closed;
+      }
+    }
+  }
+  CoordinatesSoA<float> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  return closed + close_inside_polytope_scalar(tail_cloud, cloud_size - k,
+                                               planes, planes_size, origin,
+                                               tolerance, open_set + k);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// AVX-512, single precision
+////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx512f"))) __m512
+gather_avx512(const float *base, const std::size_t *indices) {
+  __m256 lo = _mm512_i64gather_ps(_mm512_loadu_si512(indices), base, 4);
+  __m256 hi = _mm512_i64gather_ps(_mm512_loadu_si512(indices + 8), base, 4);
+  return _mm512_castpd_ps(
+      _mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(lo)),
+                         _mm256_castps_pd(hi), 1));
+}
+
+__attribute__((target("avx512f"))) ArgMax<float> farthest_in_subset_avx512(
+    const CoordinatesSoA<float> &cloud, const std::size_t *subset,
+    std::size_t subset_size, const Vector3<float> &point,
+    const Vector3<float> &normal, float threshold) {
+  if (MAX_SIMD_SIZE < subset_size) {
+    return farthest_in_subset_scalar(cloud, subset, subset_size, point, normal,
+                                     threshold);
+  }
+  const __m512 px = _mm512_set1_ps(point.x);
+  const __m512 py = _mm512_set1_ps(point.y);
+  const __m512 pz = _mm512_set1_ps(point.z);
+  const __m512 nx = _mm512_set1_ps(normal.x);
+  const __m512 ny = _mm512_set1_ps(normal.y);
+  const __m512 nz = _mm512_set1_ps(normal.z);
+  __m512 best = _mm512_set1_ps(threshold);
+  __m512i best_position = _mm512_set1_epi32(-1);
+  __m512i position = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                       12, 13, 14, 15);
+  const __m512i step = _mm512_set1_epi32(16);
+
+  std::size_t k = 0;
+  for (; k + 16 <= subset_size; k += 16) {
+    __m512 x = _mm512_sub_ps(gather_avx512(cloud.x, subset + k), px);
+    __m512 y = _mm512_sub_ps(gather_avx512(cloud.y, subset + k), py);
+    __m512 z = _mm512_sub_ps(gather_avx512(cloud.z, subset + k), pz);
+    __m512 distance =
+        _mm512_fmadd_ps(z, nz, _mm512_fmadd_ps(y, ny, _mm512_mul_ps(x, nx)));
+    __mmask16 mask = _mm512_cmp_ps_mask(distance, best, _CMP_GT_OQ);
+    best = _mm512_mask_blend_ps(mask, best, distance);
+    best_position = _mm512_mask_blend_epi32(mask, best_position, position);
+    position = _mm512_add_epi32(position, step);
+  }
+
+  alignas(64) float values[16];
+  alignas(64) std::int32_t positions[16];
+  _mm512_store_ps(values, best);
+  _mm512_store_si512(positions, best_position);
+  ArgMax<float> result{0, threshold};
+  reduce_lanes<16>(result, values, positions);
+  if (result.value != threshold) {
+    result.index = subset[result.index];
+  }
+
+  ArgMax<float> tail = farthest_in_subset_scalar(
+      cloud, subset + k, subset_size - k, point, normal, result.value);
+  return (tail.value == result.value) ? result : tail;
+}
+
+__attribute__((target("avx512f"))) ArgMax<float>
+farthest_in_cloud_avx512(const CoordinatesSoA<float> &cloud,
+                         std::size_t cloud_size,
+                         const QuadraticDistance<float> &distance,
+                         float threshold) {
+  if (MAX_SIMD_SIZE < cloud_size) {
+    return farthest_in_cloud_scalar(cloud, cloud_size, distance, threshold);
+  }
+  const __m512 ox = _mm512_set1_ps(distance.origin.x);
+  const __m512 oy = _mm512_set1_ps(distance.origin.y);
+  const __m512 oz = _mm512_set1_ps(distance.origin.z);
+  const __m512 ux = _mm512_set1_ps(distance.direction.x);
+  const __m512 uy = _mm512_set1_ps(distance.direction.y);
+  const __m512 uz = _mm512_set1_ps(distance.direction.z);
+  const __m512 norm_coeff = _mm512_set1_ps(distance.norm_coeff);
+  const __m512 direction_coeff = _mm512_set1_ps(distance.direction_coeff);
+  __m512 best = _mm512_set1_ps(threshold);
+  __m512i best_position = _mm512_set1_epi32(-1);
+  __m512i position = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                       12, 13, 14, 15);
+  const __m512i step = _mm512_set1_epi32(16);
+
+  std::size_t k = 0;
+  for (; k + 16 <= cloud_size; k += 16) {
+    __m512 x = _mm512_sub_ps(_mm512_loadu_ps(cloud.x + k), ox);
+    __m512 y = _mm512_sub_ps(_mm512_loadu_ps(cloud.y + k), oy);
+    __m512 z = _mm512_sub_ps(_mm512_loadu_ps(cloud.z + k), oz);
+    __m512 norm =
+        _mm512_fmadd_ps(z, z, _mm512_fmadd_ps(y, y, _mm512_mul_ps(x, x)));
+    __m512 projection =
+        _mm512_fmadd_ps(z, uz, _mm512_fmadd_ps(y, uy, _mm512_mul_ps(x, ux)));
+    __m512 value = _mm512_fmadd_ps(
+        direction_coeff, _mm512_mul_ps(projection, projection),
+        _mm512_mul_ps(norm_coeff, norm));
+    __mmask16 mask = _mm512_cmp_ps_mask(value, best, _CMP_GT_OQ);
+    best = _mm512_mask_blend_ps(mask, best, value);
+    best_position = _mm512_mask_blend_epi32(mask, best_position, position);
+    position = _mm512_add_epi32(position, step);
+  }
+
+  alignas(64) float values[16];
+  alignas(64) std::int32_t positions[16];
+  _mm512_store_ps(values, best);
+  _mm512_store_si512(positions, best_position);
+  ArgMax<float> result{0, threshold};
+  reduce_lanes<16>(result, values, positions);
+
+  CoordinatesSoA<float> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  ArgMax<float> tail = farthest_in_cloud_scalar(tail_cloud, cloud_size - k,
+                                                distance, result.value);
+  if (tail.value == result.value) {
+    return result;
+  }
+  tail.index += k;
+  return tail;
+}
+
+__attribute__((target("avx512f"))) ArgMax<float>
+farthest_along_direction_avx512(const CoordinatesSoA<float> &cloud,
+                                std::size_t cloud_size,
+                                const Vector3<float> &direction) {
+  if (MAX_SIMD_SIZE < cloud_size) {
+    return farthest_along_direction_scalar(cloud, cloud_size, direction);
+  }
+  const __m512 ux = _mm512_set1_ps(direction.x);
+  const __m512 uy = _mm512_set1_ps(direction.y);
+  const __m512 uz = _mm512_set1_ps(direction.z);
+  __m512 best = _mm512_set1_ps(std::numeric_limits<float>::lowest());
+  __m512i best_position = _mm512_set1_epi32(-1);
+  __m512i position = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                       12, 13, 14, 15);
+  const __m512i step = _mm512_set1_epi32(16);
+
+  std::size_t k = 0;
+  for (; k + 16 <= cloud_size; k += 16) {
+    __m512 value = _mm512_fmadd_ps(
+        _mm512_loadu_ps(cloud.z + k), uz,
+        _mm512_fmadd_ps(_mm512_loadu_ps(cloud.y + k), uy,
+                        _mm512_mul_ps(_mm512_loadu_ps(cloud.x + k), ux)));
+    __mmask16 mask = _mm512_cmp_ps_mask(value, best, _CMP_GT_OQ);
+    best = _mm512_mask_blend_ps(mask, best, value);
+    best_position = _mm512_mask_blend_epi32(mask, best_position, position);
+    position = _mm512_add_epi32(position, step);
+  }
+
+  alignas(64) float values[16];
+  alignas(64) std::int32_t positions[16];
+  _mm512_store_ps(values, best);
+  _mm512_store_si512(positions, best_position);
+  ArgMax<float> result{0, std::numeric_limits<float>::lowest()};
+  reduce_lanes<16>(result, values, positions);
+
+  CoordinatesSoA<float> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  ArgMax<float> tail =
+      farthest_along_direction_scalar(tail_cloud, cloud_size - k, direction);
+  if (!(result.value < tail.value)) {
+    return result;
+  }
+  tail.index += k;
+  return tail;
+}
+
+__attribute__((target("avx512f"))) std::size_t close_inside_polytope_avx512(
+    const CoordinatesSoA<float> &cloud, std::size_t cloud_size,
+    const Plane<float> *planes, std::size_t planes_size,
+    const Vector3<float> &origin, float tolerance, std::uint8_t *open_set) {
+  const __m512 threshold = _mm512_set1_ps(-tolerance);
+  const __m512 origin_x = _mm512_set1_ps(origin.x);
+  const __m512 origin_y = _mm512_set1_ps(origin.y);
+  const __m512 origin_z = _mm512_set1_ps(origin.z);
+  std::size_t closed = 0;
+  std::size_t k = 0;
+  for (; k + 16 <= cloud_size; k += 16) {
+    const __m512 x = _mm512_sub_ps(_mm512_loadu_ps(cloud.x + k), origin_x);
+    const __m512 y = _mm512_sub_ps(_mm512_loadu_ps(cloud.y + k), origin_y);
+    const __m512 z = _mm512_sub_ps(_mm512_loadu_ps(cloud.z + k), origin_z);
+    __m512 distance = _mm512_set1_ps(std::numeric_limits<float>::lowest());
+    for (std::size_t p = 0; p < planes_size; ++p) {
+      const auto &plane = planes[p];
+      __m512 value = _mm512_fmadd_ps(
+          z, _mm512_set1_ps(plane.normal.z),
+          _mm512_fmadd_ps(
+              y, _mm512_set1_ps(plane.normal.y),
+              _mm512_fmsub_ps(x, _mm512_set1_ps(plane.normal.x),
+                              _mm512_set1_ps(plane.offset))));
+      distance = _mm512_max_ps(distance, value);
+    }
+    unsigned mask = _mm512_cmp_ps_mask(distance, threshold, _CMP_LT_OQ);
+    for (std::size_t l = 0; mask != 0; ++l, mask >>= 1) {
+      if ((mask & 1) && (open_set[k + l] != 0)) {
+        open_set[k + l] = 0;
+        ++closed;
+      }
+    }
+  }
+  CoordinatesSoA<float> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  return closed + close_inside_polytope_scalar(tail_cloud, cloud_size - k,
+                                               planes, planes_size, origin,
+                                               tolerance, open_set + k);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// AVX2, double precision
+////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2,fma"))) ArgMax<double>
+farthest_in_subset_avx2(const CoordinatesSoA<double> &cloud,
+                        const std::size_t *subset, std::size_t subset_size,
+                        const Vector3<double> &point,
+                        const Vector3<double> &normal, double threshold) {
+  const __m256d px = _mm256_set1_pd(point.x);
+  const __m256d py = _mm256_set1_pd(point.y);
+  const __m256d pz = _mm256_set1_pd(point.z);
+  const __m256d nx = _mm256_set1_pd(normal.x);
+  const __m256d ny = _mm256_set1_pd(normal.y);
+  const __m256d nz = _mm256_set1_pd(normal.z);
+  __m256d best = _mm256_set1_pd(threshold);
+  __m256i best_position = _mm256_set1_epi64x(-1);
+  __m256i position = _mm256_setr_epi64x(0, 1, 2, 3);
+  const __m256i step = _mm256_set1_epi64x(4);
+
+  std::size_t k = 0;
+  for (; k + 4 <= subset_size; k += 4) {
+    __m256i indices =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(subset + k));
+    __m256d x = _mm256_sub_pd(_mm256_i64gather_pd(cloud.x, indices, 8), px);
+    __m256d y = _mm256_sub_pd(_mm256_i64gather_pd(cloud.y, indices, 8), py);
+    __m256d z = _mm256_sub_pd(_mm256_i64gather_pd(cloud.z, indices, 8), pz);
+    __m256d distance =
+        _mm256_fmadd_pd(z, nz, _mm256_fmadd_pd(y, ny, _mm256_mul_pd(x, nx)));
+    __m256d mask = _mm256_cmp_pd(distance, best, _CMP_GT_OQ);
+    best = _mm256_blendv_pd(best, distance, mask);
+    best_position = _mm256_castpd_si256(
+        _mm256_blendv_pd(_mm256_castsi256_pd(best_position),
+                         _mm256_castsi256_pd(position), mask));
+    position = _mm256_add_epi64(position, step);
+  }
+
+  alignas(32) double values[4];
+  alignas(32) std::int64_t positions[4];
+  _mm256_store_pd(values, best);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(positions), best_position);
+  ArgMax<double> result{0, threshold};
+  reduce_lanes<4>(result, values, positions);
+  if (result.value != threshold) {
+    result.index = subset[result.index];
+  }
+
+  ArgMax<double> tail = farthest_in_subset_scalar(
+      cloud, subset + k, subset_size - k, point, normal, result.value);
+  return (tail.value == result.value) ? result : tail;
+}
+
+__attribute__((target("avx2,fma"))) ArgMax<double>
+farthest_in_cloud_avx2(const CoordinatesSoA<double> &cloud,
+                       std::size_t cloud_size,
+                       const QuadraticDistance<double> &distance,
+                       double threshold) {
+  const __m256d ox = _mm256_set1_pd(distance.origin.x);
+  const __m256d oy = _mm256_set1_pd(distance.origin.y);
+  const __m256d oz = _mm256_set1_pd(distance.origin.z);
+  const __m256d ux = _mm256_set1_pd(distance.direction.x);
+  const __m256d uy = _mm256_set1_pd(distance.direction.y);
+  const __m256d uz = _mm256_set1_pd(distance.direction.z);
+  const __m256d norm_coeff = _mm256_set1_pd(distance.norm_coeff);
+  const __m256d direction_coeff = _mm256_set1_pd(distance.direction_coeff);
+  __m256d best = _mm256_set1_pd(threshold);
+  __m256i best_position = _mm256_set1_epi64x(-1);
+  __m256i position = _mm256_setr_epi64x(0, 1, 2, 3);
+  const __m256i step = _mm256_set1_epi64x(4);
+
+  std::size_t k = 0;
+  for (; k + 4 <= cloud_size; k += 4) {
+    __m256d x = _mm256_sub_pd(_mm256_loadu_pd(cloud.x + k), ox);
+    __m256d y = _mm256_sub_pd(_mm256_loadu_pd(cloud.y + k), oy);
+    __m256d z = _mm256_sub_pd(_mm256_loadu_pd(cloud.z + k), oz);
+    __m256d norm =
+        _mm256_fmadd_pd(z, z, _mm256_fmadd_pd(y, y, _mm256_mul_pd(x, x)));
+    __m256d projection =
+        _mm256_fmadd_pd(z, uz, _mm256_fmadd_pd(y, uy, _mm256_mul_pd(x, ux)));
+    __m256d value = _mm256_fmadd_pd(
+        direction_coeff, _mm256_mul_pd(projection, projection),
+        _mm256_mul_pd(norm_coeff, norm));
+    __m256d mask = _mm256_cmp_pd(value, best, _CMP_GT_OQ);
+    best = _mm256_blendv_pd(best, value, mask);
+    best_position = _mm256_castpd_si256(
+        _mm256_blendv_pd(_mm256_castsi256_pd(best_position),
+                         _mm256_castsi256_pd(position), mask));
+    position = _mm256_add_epi64(position, step);
+  }
+
+  alignas(32) double values[4];
+  alignas(32) std::int64_t positions[4];
+  _mm256_store_pd(values, best);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(positions), best_position);
+  ArgMax<double> result{0, threshold};
+  reduce_lanes<4>(result, values, positions);
+
+  CoordinatesSoA<double> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  ArgMax<double> tail = farthest_in_cloud_scalar(tail_cloud, cloud_size - k,
+                                                 distance, result.value);
+  if (tail.value == result.value) {
+    return result;
+  }
+  tail.index += k;
+  return tail;
+}
+
+__attribute__((target("avx2,fma"))) ArgMax<double>
+farthest_along_direction_avx2(const CoordinatesSoA<double> &cloud,
+                              std::size_t cloud_size,
+                              const Vector3<double> &direction) {
+  const __m256d ux = _mm256_set1_pd(direction.x);
+  const __m256d uy = _mm256_set1_pd(direction.y);
+  const __m256d uz = _mm256_set1_pd(direction.z);
+  __m256d best = _mm256_set1_pd(std::numeric_limits<double>::lowest());
+  __m256i best_position = _mm256_set1_epi64x(-1);
+  __m256i position = _mm256_setr_epi64x(0, 1, 2, 3);
+  const __m256i step = _mm256_set1_epi64x(4);
+
+  std::size_t k = 0;
+  for (; k + 4 <= cloud_size; k += 4) {
+    __m256d value = _mm256_fmadd_pd(
+        _mm256_loadu_pd(cloud.z + k), uz,
+        _mm256_fmadd_pd(_mm256_loadu_pd(cloud.y + k), uy,
+                        _mm256_mul_pd(_mm256_loadu_pd(cloud.x + k), ux)));
+    __m256d mask = _mm256_cmp_pd(value, best, _CMP_GT_OQ);
+    best = _mm256_blendv_pd(best, value, mask);
+    best_position = _mm256_castpd_si256(
+        _mm256_blendv_pd(_mm256_castsi256_pd(best_position),
+                         _mm256_castsi256_pd(position), mask));
+    position = _mm256_add_epi64(position, step);
+  }
+
+  alignas(32) double values[4];
+  alignas(32) std::int64_t positions[4];
+  _mm256_store_pd(values, best);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(positions), best_position);
+  ArgMax<double> result{0, std::numeric_limits<double>::lowest()};
+  reduce_lanes<4>(result, values, positions);
+
+  CoordinatesSoA<double> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  ArgMax<double> tail =
+      farthest_along_direction_scalar(tail_cloud, cloud_size - k, direction);
+  if (!(result.value < tail.value)) {
+    return result;
+  }
+  tail.index += k;
+  return tail;
+}
+
+__attribute__((target("avx2,fma"))) std::size_t close_inside_polytope_avx2(
+    const CoordinatesSoA<double> &cloud, std::size_t cloud_size,
+    const Plane<double> *planes, std::size_t planes_size,
+    const Vector3<double> &origin, double tolerance, std::uint8_t *open_set) {
+  const __m256d threshold = _mm256_set1_pd(-tolerance);
+  const __m256d origin_x = _mm256_set1_pd(origin.x);
+  const __m256d origin_y = _mm256_set1_pd(origin.y);
+  const __m256d origin_z = _mm256_set1_pd(origin.z);
+  std::size_t closed = 0;
+  std::size_t k = 0;
+  for (; k + 4 <= cloud_size; k += 4) {
+    const __m256d x = _mm256_sub_pd(_mm256_loadu_pd(cloud.x + k), origin_x);
+    const __m256d y = _mm256_sub_pd(_mm256_loadu_pd(cloud.y + k), origin_y);
+    const __m256d z = _mm256_sub_pd(_mm256_loadu_pd(cloud.z + k), origin_z);
+    __m256d distance = _mm256_set1_pd(std::numeric_limits<double>::lowest());
+    for (std::size_t p = 0; p < planes_size; ++p) {
+      const auto &plane = planes[p];
+      __m256d value = _mm256_fmadd_pd(
+          z, _mm256_set1_pd(plane.normal.z),
+          _mm256_fmadd_pd(
+              y, _mm256_set1_pd(plane.normal.y),
+              _mm256_fmsub_pd(x, _mm256_set1_pd(plane.normal.x),
+                              _mm256_set1_pd(plane.offset))));
+      distance = _mm256_max_pd(distance, value);
+    }
+    int mask =
+        _mm256_movemask_pd(_mm256_cmp_pd(distance, threshold, _CMP_LT_OQ));
+    for (std::size_t l = 0; mask != 0; ++l, mask >>= 1) {
+      if ((mask & 1) && (open_set[k + l] != 0)) {
+        open_set[k + l] = 0;
+        ++closed;
+      }
+    }
+  }
+  CoordinatesSoA<double> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  return closed + close_inside_polytope_scalar(tail_cloud, cloud_size - k,
+                                               planes, planes_size, origin,
+                                               tolerance, open_set + k);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// AVX-512, double precision
+////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx512f"))) ArgMax<double>
+farthest_in_subset_avx512(const CoordinatesSoA<double> &cloud,
+                          const std::size_t *subset, std::size_t subset_size,
+                          const Vector3<double> &point,
+                          const Vector3<double> &normal, double threshold) {
+  const __m512d px = _mm512_set1_pd(point.x);
+  const __m512d py = _mm512_set1_pd(point.y);
+  const __m512d pz = _mm512_set1_pd(point.z);
+  const __m512d nx = _mm512_set1_pd(normal.x);
+  const __m512d ny = _mm512_set1_pd(normal.y);
+  const __m512d nz = _mm512_set1_pd(normal.z);
+  __m512d best = _mm512_set1_pd(threshold);
+  __m512i best_position = _mm512_set1_epi64(-1);
+  __m512i position = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+  const __m512i step = _mm512_set1_epi64(8);
+
+  std::size_t k = 0;
+  for (; k + 8 <= subset_size; k += 8) {
+    __m512i indices = _mm512_loadu_si512(subset + k);
+    __m512d x = _mm512_sub_pd(_mm512_i64gather_pd(indices, cloud.x, 8), px);
+    __m512d y = _mm512_sub_pd(_mm512_i64gather_pd(indices, cloud.y, 8), py);
+    __m512d z = _mm512_sub_pd(_mm512_i64gather_pd(indices, cloud.z, 8), pz);
+    __m512d distance =
+        _mm512_fmadd_pd(z, nz, _mm512_fmadd_pd(y, ny, _mm512_mul_pd(x, nx)));
+    __mmask8 mask = _mm512_cmp_pd_mask(distance, best, _CMP_GT_OQ);
+    best = _mm512_mask_blend_pd(mask, best, distance);
+    best_position = _mm512_mask_blend_epi64(mask, best_position, position);
+    position = _mm512_add_epi64(position, step);
+  }
+
+  alignas(64) double values[8];
+  alignas(64) std::int64_t positions[8];
+  _mm512_store_pd(values, best);
+  _mm512_store_si512(positions, best_position);
+  ArgMax<double> result{0, threshold};
+  reduce_lanes<8>(result, values, positions);
+  if (result.value != threshold) {
+    result.index = subset[result.index];
+  }
+
+  ArgMax<double> tail = farthest_in_subset_scalar(
+      cloud, subset + k, subset_size - k, point, normal, result.value);
+  return (tail.value == result.value) ? result : tail;
+}
+
+__attribute__((target("avx512f"))) ArgMax<double>
+farthest_in_cloud_avx512(const CoordinatesSoA<double> &cloud,
+                         std::size_t cloud_size,
+                         const QuadraticDistance<double> &distance,
+                         double threshold) {
+  const __m512d ox = _mm512_set1_pd(distance.origin.x);
+  const __m512d oy = _mm512_set1_pd(distance.origin.y);
+  const __m512d oz = _mm512_set1_pd(distance.origin.z);
+  const __m512d ux = _mm512_set1_pd(distance.direction.x);
+  const __m512d uy = _mm512_set1_pd(distance.direction.y);
+  const __m512d uz = _mm512_set1_pd(distance.direction.z);
+  const __m512d norm_coeff = _mm512_set1_pd(distance.norm_coeff);
+  const __m512d direction_coeff = _mm512_set1_pd(distance.direction_coeff);
+  __m512d best = _mm512_set1_pd(threshold);
+  __m512i best_position = _mm512_set1_epi64(-1);
+  __m512i position = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+  const __m512i step = _mm512_set1_epi64(8);
+
+  std::size_t k = 0;
+  for (; k + 8 <= cloud_size; k += 8) {
+    __m512d x = _mm512_sub_pd(_mm512_loadu_pd(cloud.x + k), ox);
+    __m512d y = _mm512_sub_pd(_mm512_loadu_pd(cloud.y + k), oy);
+    __m512d z = _mm512_sub_pd(_mm512_loadu_pd(cloud.z + k), oz);
+    __m512d norm =
+        _mm512_fmadd_pd(z, z, _mm512_fmadd_pd(y, y, _mm512_mul_pd(x, x)));
+    __m512d projection =
+        _mm512_fmadd_pd(z, uz, _mm512_fmadd_pd(y, uy, _mm512_mul_pd(x, ux)));
+    __m512d value = _mm512_fmadd_pd(
+        direction_coeff, _mm512_mul_pd(projection, projection),
+        _mm512_mul_pd(norm_coeff, norm));
+    __mmask8 mask = _mm512_cmp_pd_mask(value, best, _CMP_GT_OQ);
+    best = _mm512_mask_blend_pd(mask, best, value);
+    best_position = _mm512_mask_blend_epi64(mask, best_position, position);
+    position = _mm512_add_epi64(position, step);
+  }
+
+  alignas(64) double values[8];
+  alignas(64) std::int64_t positions[8];
+  _mm512_store_pd(values, best);
+  _mm512_store_si512(positions, best_position);
+  ArgMax<double> result{0, threshold};
+  reduce_lanes<8>(result, values, positions);
+
+  CoordinatesSoA<double> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  ArgMax<double> tail = farthest_in_cloud_scalar(tail_cloud, cloud_size - k,
+                                                 distance, result.value);
+  if (tail.value == result.value) {
+    return result;
+  }
+  tail.index += k;
+  return tail;
+}
+
+__attribute__((target("avx512f"))) ArgMax<double>
+farthest_along_direction_avx512(const CoordinatesSoA<double> &cloud,
+                                std::size_t cloud_size,
+                                const Vector3<double> &direction) {
+  const __m512d ux = _mm512_set1_pd(direction.x);
+  const __m512d uy = _mm512_set1_pd(direction.y);
+  const __m512d uz = _mm512_set1_pd(direction.z);
+  __m512d best = _mm512_set1_pd(std::numeric_limits<double>::lowest());
+  __m512i best_position = _mm512_set1_epi64(-1);
+  __m512i position = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+  const __m512i step = _mm512_set1_epi64(8);
+
+  std::size_t k = 0;
+  for (; k + 8 <= cloud_size; k += 8) {
+    __m512d value = _mm512_fmadd_pd(
+        _mm512_loadu_pd(cloud.z + k), uz,
+        _mm512_fmadd_pd(_mm512_loadu_pd(cloud.y + k), uy,
+                        _mm512_mul_pd(_mm512_loadu_pd(cloud.x + k), ux)));
+    __mmask8 mask = _mm512_cmp_pd_mask(value, best, _CMP_GT_OQ);
+    best = _mm512_mask_blend_pd(mask, best, value);
+    best_position = _mm512_mask_blend_epi64(mask, best_position, position);
+    position = _mm512_add_epi64(position, step);
+  }
+
+  alignas(64) double values[8];
+  alignas(64) std::int64_t positions[8];
+  _mm512_store_pd(values, best);
+  _mm512_store_si512(positions, best_position);
+  ArgMax<double> result{0, std::numeric_limits<double>::lowest()};
+  reduce_lanes<8>(result, values, positions);
+
+  CoordinatesSoA<double> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  ArgMax<double> tail =
+      farthest_along_direction_scalar(tail_cloud, cloud_size - k, direction);
+  if (!(result.value < tail.value)) {
+    return result;
+  }
+  tail.index += k;
+  return tail;
+}
+
+__attribute__((target("avx512f"))) std::size_t close_inside_polytope_avx512(
+    const CoordinatesSoA<double> &cloud, std::size_t cloud_size,
+    const Plane<double> *planes, std::size_t planes_size,
+    const Vector3<double> &origin, double tolerance, std::uint8_t *open_set) {
+  const __m512d threshold = _mm512_set1_pd(-tolerance);
+  const __m512d origin_x = _mm512_set1_pd(origin.x);
+  const __m512d origin_y = _mm512_set1_pd(origin.y);
+  const __m512d origin_z = _mm512_set1_pd(origin.z);
+  std::size_t closed = 0;
+  std::size_t k = 0;
+  for (; k + 8 <= cloud_size; k += 8) {
+    const __m512d x = _mm512_sub_pd(_mm512_loadu_pd(cloud.x + k), origin_x);
+    const __m512d y = _mm512_sub_pd(_mm512_loadu_pd(cloud.y + k), origin_y);
+    const __m512d z = _mm512_sub_pd(_mm512_loadu_pd(cloud.z + k), origin_z);
+    __m512d distance = _mm512_set1_pd(std::numeric_limits<double>::lowest());
+    for (std::size_t p = 0; p < planes_size; ++p) {
+      const auto &plane = planes[p];
+      __m512d value = _mm512_fmadd_pd(
+          z, _mm512_set1_pd(plane.normal.z),
+          _mm512_fmadd_pd(
+              y, _mm512_set1_pd(plane.normal.y),
+              _mm512_fmsub_pd(x, _mm512_set1_pd(plane.normal.x),
+                              _mm512_set1_pd(plane.offset))));
+      distance = _mm512_max_pd(distance, value);
+    }
+    unsigned mask = _mm512_cmp_pd_mask(distance, threshold, _CMP_LT_OQ);
+    for (std::size_t l = 0; mask != 0; ++l, mask >>= 1) {
+      if ((mask & 1) && (open_set[k + l] != 0)) {
+        open_set[k + l] = 0;
+        ++closed;
+      }
+    }
+  }
+  CoordinatesSoA<double> tail_cloud{cloud.x + k, cloud.y + k, cloud.z + k};
+  return closed + close_inside_polytope_scalar(tail_cloud, cloud_size - k,
+                                               planes, planes_size, origin,
+                                               tolerance, open_set + k);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// AVX2 and AVX-512, mass properties
+////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2,fma"))) double reduce_avx2(__m256d value) {
+  alignas(32) double lanes[4];
+  _mm256_store_pd(lanes, value);
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+__attribute__((target("avx2,fma"))) void
+accumulate_mass_avx2(const TrianglesSoA &triangles, std::size_t size,
+                     MassSums &sums) {
+  __m256d volume = _mm256_setzero_pd();
+  __m256d area = _mm256_setzero_pd();
+  __m256d first[3], second[6];
+  for (auto &sum : first) {
+    sum = _mm256_setzero_pd();
+  }
+  for (auto &sum : second) {
+    sum = _mm256_setzero_pd();
+  }
+
+  std::size_t k = 0;
+  for (; k + 4 <= size; k += 4) {
+    const __m256d a[3] = {_mm256_loadu_pd(triangles.a.x + k),
+                          _mm256_loadu_pd(triangles.a.y + k),
+                          _mm256_loadu_pd(triangles.a.z + k)};
+    const __m256d b[3] = {_mm256_loadu_pd(triangles.b.x + k),
+                          _mm256_loadu_pd(triangles.b.y + k),
+                          _mm256_loadu_pd(triangles.b.z + k)};
+    const __m256d c[3] = {_mm256_loadu_pd(triangles.c.x + k),
+                          _mm256_loadu_pd(triangles.c.y + k),
+                          _mm256_loadu_pd(triangles.c.z + k)};
+    const __m256d det = _mm256_fmadd_pd(
+        a[2], _mm256_fmsub_pd(b[0], c[1], _mm256_mul_pd(b[1], c[0])),
+        _mm256_fmadd_pd(
+            a[1], _mm256_fmsub_pd(b[2], c[0], _mm256_mul_pd(b[0], c[2])),
+            _mm256_mul_pd(
+                a[0], _mm256_fmsub_pd(b[1], c[2], _mm256_mul_pd(b[2], c[1])))));
+    __m256d u[3], v[3], s[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+      u[i] = _mm256_sub_pd(b[i], a[i]);
+      v[i] = _mm256_sub_pd(c[i], a[i]);
+      s[i] = _mm256_add_pd(_mm256_add_pd(a[i], b[i]), c[i]);
+    }
+    const __m256d nx = _mm256_fmsub_pd(u[1], v[2], _mm256_mul_pd(u[2], v[1]));
+    const __m256d ny = _mm256_fmsub_pd(u[2], v[0], _mm256_mul_pd(u[0], v[2]));
+    const __m256d nz = _mm256_fmsub_pd(u[0], v[1], _mm256_mul_pd(u[1], v[0]));
+    area = _mm256_add_pd(
+        area, _mm256_sqrt_pd(_mm256_fmadd_pd(
+                  nz, nz, _mm256_fmadd_pd(ny, ny, _mm256_mul_pd(nx, nx)))));
+    volume = _mm256_add_pd(volume, det);
+    for (std::size_t i = 0; i < 3; ++i) {
+      first[i] = _mm256_fmadd_pd(det, s[i], first[i]);
+    }
+    for (std::size_t p = 0; p < 6; ++p) {
+      const std::size_t i = SECOND_ORDER_PAIRS[p][0];
+      const std::size_t j = SECOND_ORDER_PAIRS[p][1];
+      const __m256d products = _mm256_fmadd_pd(
+          s[i], s[j],
+          _mm256_fmadd_pd(
+              c[i], c[j],
+              _mm256_fmadd_pd(b[i], b[j], _mm256_mul_pd(a[i], a[j]))));
+      second[p] = _mm256_fmadd_pd(det, products, second[p]);
+    }
+  }
+
+  sums.volume += reduce_avx2(volume);
+  sums.area += reduce_avx2(area);
+  for (std::size_t i = 0; i < 3; ++i) {
+    sums.first[i] += reduce_avx2(first[i]);
+  }
+  for (std::size_t p = 0; p < 6; ++p) {
+    sums.second[p] += reduce_avx2(second[p]);
+  }
+  accumulate_mass_scalar(advance(triangles, k), size - k, sums);
+}
+
+__attribute__((target("avx512f"))) void
+accumulate_mass_avx512(const TrianglesSoA &triangles, std::size_t size,
+                       MassSums &sums) {
+  __m512d volume = _mm512_setzero_pd();
+  __m512d area = _mm512_setzero_pd();
+  __m512d first[3], second[6];
+  for (auto &sum : first) {
+    sum = _mm512_setzero_pd();
+  }
+  for (auto &sum : second) {
+    sum = _mm512_setzero_pd();
+  }
+
+  std::size_t k = 0;
+  for (; k + 8 <= size; k += 8) {
+    const __m512d a[3] = {_mm512_loadu_pd(triangles.a.x + k),
+                          _mm512_loadu_pd(triangles.a.y + k),
+                          _mm512_loadu_pd(triangles.a.z + k)};
+    const __m512d b[3] = {_mm512_loadu_pd(triangles.b.x + k),
+                          _mm512_loadu_pd(triangles.b.y + k),
+                          _mm512_loadu_pd(triangles.b.z + k)};
+    const __m512d c[3] = {_mm512_loadu_pd(triangles.c.x + k),
+                          _mm512_loadu_pd(triangles.c.y + k),
+                          _mm512_loadu_pd(triangles.c.z + k)};
+    const __m512d det = _mm512_fmadd_pd(
+        a[2], _mm512_fmsub_pd(b[0], c[1], _mm512_mul_pd(b[1], c[0])),
+        _mm512_fmadd_pd(
+            a[1], _mm512_fmsub_pd(b[2], c[0], _mm512_mul_pd(b[0], c[2])),
+            _mm512_mul_pd(
+                a[0], _mm512_fmsub_pd(b[1], c[2], _mm512_mul_pd(b[2], c[1])))));
+    __m512d u[3], v[3], s[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+      u[i] = _mm512_sub_pd(b[i], a[i]);
+      v[i] = _mm512_sub_pd(c[i], a[i]);
+      s[i] = _mm512_add_pd(_mm512_add_pd(a[i], b[i]), c[i]);
+    }
+    const __m512d nx = _mm512_fmsub_pd(u[1], v[2], _mm512_mul_pd(u[2], v[1]));
+    const __m512d ny = _mm512_fmsub_pd(u[2], v[0], _mm512_mul_pd(u[0], v[2]));
+    const __m512d nz = _mm512_fmsub_pd(u[0], v[1], _mm512_mul_pd(u[1], v[0]));
+    area = _mm512_add_pd(
+        area, _mm512_sqrt_pd(_mm512_fmadd_pd(
+                  nz, nz, _mm512_fmadd_pd(ny, ny, _mm512_mul_pd(nx, nx)))));
+    volume = _mm512_add_pd(volume, det);
+    for (std::size_t i = 0; i < 3; ++i) {
+      first[i] = _mm512_fmadd_pd(det, s[i], first[i]);
+    }
+    for (std::size_t p = 0; p < 6; ++p) {
+      const std::size_t i = SECOND_ORDER_PAIRS[p][0];
+      const std::size_t j = SECOND_ORDER_PAIRS[p][1];
+      const __m512d products = _mm512_fmadd_pd(
+          s[i], s[j],
+          _mm512_fmadd_pd(
+              c[i], c[j],
+              _mm512_fmadd_pd(b[i], b[j], _mm512_mul_pd(a[i], a[j]))));
+      second[p] = _mm512_fmadd_pd(det, products, second[p]);
+    }
+  }
+
+  sums.volume += _mm512_reduce_add_pd(volume);
+  sums.area += _mm512_reduce_add_pd(area);
+  for (std::size_t i = 0; i < 3; ++i) {
+    sums.first[i] += _mm512_reduce_add_pd(first[i]);
+  }
+  for (std::size_t p = 0; p < 6; ++p) {
+    sums.second[p] += _mm512_reduce_add_pd(second[p]);
+  }
+  accumulate_mass_scalar(advance(triangles, k), size - k, sums);
+}
+#endif
+
+template <typename Scalar> Kernels<Scalar> select_kernels() {
+#ifdef QH_SIMD_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return Kernels<Scalar>{"AVX-512", &farthest_in_subset_avx512,
+                           &farthest_in_cloud_avx512,
+                           &farthest_along_direction_avx512,
+                           &close_inside_polytope_avx512};
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return Kernels<Scalar>{"AVX2", &farthest_in_subset_avx2,
+                           &farthest_in_cloud_avx2,
+                           &farthest_along_direction_avx2,
+                           &close_inside_polytope_avx2};
+  }
+#endif
+  return Kernels<Scalar>{"scalar", &farthest_in_subset_scalar<Scalar>,
+                         &farthest_in_cloud_scalar<Scalar>,
+                         &farthest_along_direction_scalar<Scalar>,
+                         &close_inside_polytope_scalar<Scalar>};
+}
+} // namespace
+
+template <typename Scalar> const Kernels<Scalar> &get_kernels() {
+  static const Kernels<Scalar> kernels = select_kernels<Scalar>();
+  return kernels;
+}
+
+template const Kernels<float> &get_kernels<float>();
+template const Kernels<double> &get_kernels<double>();
+
+namespace {
+MassKernel select_mass_kernel() {
+#ifdef QH_SIMD_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return &accumulate_mass_avx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return &accumulate_mass_avx2;
+  }
+#endif
+  return &accumulate_mass_scalar;
+}
+} // namespace
+
+MassKernel get_mass_kernel() {
+  static const MassKernel kernel = select_mass_kernel();
+  return kernel;
+}
+} // namespace qh
@@ -0,0 +1,122 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace qh {
+template <typename Scalar> struct Vector3 {
+  Scalar x;
+  Scalar y;
+  Scalar z;
+};
+
+// structure of arrays view of a point cloud
+template <typename Scalar> struct CoordinatesSoA {
+  const Scalar *x;
+  const Scalar *y;
+  const Scalar *z;
+};
+
+template <typename Scalar> struct ArgMax {
+  std::size_t index;
+  // equal to the passed threshold when no vertex exceeded it
+  Scalar value;
+};
+
+// value(p) = norm_coeff * |p - origin|^2 + direction_coeff * <p - origin,
+// direction>^2
+// which can describe the squared distance to a point, a line or a plane
+template <typename Scalar> struct QuadraticDistance {
+  Vector3<Scalar> origin;
+  Scalar norm_coeff;
+  Vector3<Scalar> direction;
+  Scalar direction_coeff;
+};
+
+// the points p such that <p, normal> = offset
+template <typename Scalar> struct Plane {
+  Vector3<Scalar> normal;
+  Scalar offset;
+};
+
+template <typename Scalar> struct Kernels {
+  const char *name;
+
+  // Farthest vertex, among the ones in subset, in front of the plane passing
+  // by point and having the specified normal. The returned index is the one
+  // stored in subset.
+  ArgMax<Scalar> (*farthest_in_subset)(const CoordinatesSoA<Scalar> &cloud,
+                                       const std::size_t *subset,
+                                       std::size_t subset_size,
+                                       const Vector3<Scalar> &point,
+                                       const Vector3<Scalar> &normal,
+                                       Scalar threshold);
+
+  // Farthest vertex, among all the ones in the cloud, according to the passed
+  // quadratic distance
+  ArgMax<Scalar> (*farthest_in_cloud)(const CoordinatesSoA<Scalar> &cloud,
+                                      std::size_t cloud_size,
+                                      const QuadraticDistance<Scalar> &distance,
+                                      Scalar threshold);
+
+  // Vertex of the cloud maximizing <p, direction>
+  ArgMax<Scalar> (*farthest_along_direction)(
+      const CoordinatesSoA<Scalar> &cloud, std::size_t cloud_size,
+      const Vector3<Scalar> &direction);
+
+  // Sets to 0 the flags in open_set of the vertices such that
+  // <p - origin, normal> - offset < -tolerance for every passed plane, i.e.
+  // the ones strictly inside the polytope delimited by the planes, whose
+  // offsets are expressed w.r.t. origin. Returns the number of vertices whose
+  // flag was set to 0 by this call.
+  std::size_t (*close_inside_polytope)(const CoordinatesSoA<Scalar> &cloud,
+                                       std::size_t cloud_size,
+                                       const Plane<Scalar> *planes,
+                                       std::size_t planes_size,
+                                       const Vector3<Scalar> &origin,
+                                       Scalar tolerance,
+                                       std::uint8_t *open_set);
+};
+
+// structure of arrays view of triangles, each one made of the vertices a, b
+// and c
+struct TrianglesSoA {
+  CoordinatesSoA<double> a;
+  CoordinatesSoA<double> b;
+  CoordinatesSoA<double> c;
+};
+
+// Sums over triangles, each one seen as the tethraedron connecting it to the
+// origin. Calling det = <a, b x c> (6 times the signed volume of the
+// tethraedron) and s = a + b + c:
+struct MassSums {
+  // sum of det
+  double volume = 0;
+  // sum of |(b - a) x (c - a)|
+  double area = 0;
+  // sum of det * s
+  std::array<double, 3> first = {0, 0, 0};
+  // sum of det * (a_i a_j + b_i b_j + c_i c_j + s_i s_j), for ij equal to
+  // xx, yy, zz, xy, yz, zx
+  std::array<double, 6> second = {0, 0, 0, 0, 0, 0};
+};
+
+// Adds to sums the terms of the passed triangles
+using MassKernel = void (*)(const TrianglesSoA &triangles, std::size_t size,
+                            MassSums &sums);
+
+// the most performant kernels supported by the running cpu: AVX-512, AVX2 or
+// scalar. Explicitly instantiated for float and double.
+template <typename Scalar> const Kernels<Scalar> &get_kernels();
+
+// same as above, for the mass properties kernel
+MassKernel get_mass_kernel();
+} // namespace qh
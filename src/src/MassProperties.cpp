@@ -0,0 +1,75 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include "MassProperties.h"
+
+namespace qh {
+void MassAccumulator::reset(const Vector3<double> &origin,
+                            std::size_t capacity) {
+  this->origin = origin;
+  for (auto &coordinate : coordinates) {
+    coordinate.clear();
+    coordinate.reserve(capacity);
+  }
+}
+
+void MassAccumulator::add(const Vector3<double> &a, const Vector3<double> &b,
+                          const Vector3<double> &c) {
+  std::size_t k = 0;
+  for (const auto *vertex : {&a, &b, &c}) {
+    coordinates[k++].push_back(vertex->x);
+    coordinates[k++].push_back(vertex->y);
+    coordinates[k++].push_back(vertex->z);
+  }
+}
+
+MassProperties MassAccumulator::compute() const {
+  auto vertex = [this](std::size_t first) {
+    return CoordinatesSoA<double>{coordinates[first].data(),
+                                  coordinates[first + 1].data(),
+                                  coordinates[first + 2].data()};
+  };
+  MassSums sums;
+  get_mass_kernel()(TrianglesSoA{vertex(0), vertex(3), vertex(6)},
+                    coordinates.front().size(), sums);
+
+  // each triangle is the base of a tethraedron having the other vertex in
+  // origin, whose signed contributions sum up to the ones of the solid
+  MassProperties result;
+  result.volume = sums.volume / 6.0;
+  result.surface_area = sums.area / 2.0;
+  std::array<double, 3> centroid = {0, 0, 0};
+  if (sums.volume != 0) {
+    for (std::size_t i = 0; i < 3; ++i) {
+      centroid[i] = sums.first[i] / (4.0 * sums.volume);
+    }
+  }
+  result.centroid = {origin.x + centroid[0], origin.y + centroid[1],
+                     origin.z + centroid[2]};
+
+  // second moments w.r.t. the centroid (covariance), from the ones w.r.t.
+  // origin
+  std::array<std::array<double, 3>, 3> covariance;
+  auto set_covariance = [&](std::size_t i, std::size_t j, double moment) {
+    covariance[i][j] = covariance[j][i] =
+        moment / 120.0 - result.volume * centroid[i] * centroid[j];
+  };
+  set_covariance(0, 0, sums.second[0]);
+  set_covariance(1, 1, sums.second[1]);
+  set_covariance(2, 2, sums.second[2]);
+  set_covariance(0, 1, sums.second[3]);
+  set_covariance(1, 2, sums.second[4]);
+  set_covariance(2, 0, sums.second[5]);
+  const double trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+  for (std::size_t i = 0; i < 3; ++i) {
+    for (std::size_t j = 0; j < 3; ++j) {
+      result.inertia[i][j] = ((i == j) ? trace : 0) - covariance[i][j];
+    }
+  }
+  return result;
+}
+} // namespace qh
@@ -0,0 +1,40 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include "Kernels.h"
+
+#include <array>
+#include <vector>
+
+namespace qh {
+// Gathers the triangles of a closed surface, as structure of arrays, to
+// compute the mass properties of the solid it delimits with the simd
+// kernels. The buffers are kept from one computation to the next one.
+class MassAccumulator {
+public:
+  // Forgets the triangles added so far. The vertices of the next ones are
+  // expressed w.r.t. origin, which should be close to the surface to
+  // preserve the precision: the centroid is translated back.
+  void reset(const Vector3<double> &origin, std::size_t capacity);
+
+  // counter clockwise when seen from outside the surface
+  void add(const Vector3<double> &a, const Vector3<double> &b,
+           const Vector3<double> &c);
+
+  MassProperties compute() const;
+
+private:
+  Vector3<double> origin{0, 0, 0};
+  // x, y, z of the first vertex of each triangle, then the ones of the
+  // second and of the third vertex
+  std::array<std::vector<double>, 9> coordinates;
+};
+} // namespace qh
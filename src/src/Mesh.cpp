@@ -0,0 +1,255 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace qh {
+namespace {
+// the edges of the tethraedron facets
+static constexpr Mesh::Index TETHRAEDRON[4][3] = {
+    {0, 1, 2}, {0, 1, 3}, {0, 2, 3}, {1, 2, 3}};
+
+std::uint8_t find_edge(const Mesh::Facet &facet, Mesh::Index neighbour) {
+  std::uint8_t edge = 0;
+  while ((edge < 2) && (facet.neighbours[edge] != neighbour)) {
+    ++edge;
+  }
+  return edge;
+}
+} // namespace
+
+Mesh::Index Mesh::addVertex(const hull::Coordinate &vertex,
+                            std::size_t cloud_index) {
+  vertices.push_back(vertex);
+  cloud_indices.push_back(cloud_index);
+  return static_cast<Index>(vertices.size() - 1);
+}
+
+Mesh::Index Mesh::newFacet() {
+  if (free_facets.empty()) {
+    facets.emplace_back();
+    return static_cast<Index>(facets.size() - 1);
+  }
+  Index result = free_facets.back();
+  free_facets.pop_back();
+  return result;
+}
+
+void Mesh::setNormal(Facet &facet) const {
+  const auto &A = vertices[facet.vertices[0]];
+  hull::Coordinate AB, AC;
+  hull::diff(AB, vertices[facet.vertices[1]], A);
+  hull::diff(AC, vertices[facet.vertices[2]], A);
+  hull::cross(facet.normal, AB, AC);
+  const float length = std::sqrt(hull::normSquared(facet.normal));
+  if (0 < length) {
+    facet.normal.x /= length;
+    facet.normal.y /= length;
+    facet.normal.z /= length;
+  }
+}
+
+void Mesh::reset(const std::array<hull::Coordinate, 4> &vertices,
+                 const std::array<std::size_t, 4> &cloud_indices) {
+  this->vertices.clear();
+  this->cloud_indices.clear();
+  facets.clear();
+  free_facets.clear();
+  last_update.changed.clear();
+  last_update.added.clear();
+  last_update.removed.clear();
+
+  hull::Coordinate center{0, 0, 0};
+  for (std::size_t k = 0; k < 4; ++k) {
+    addVertex(vertices[k], cloud_indices[k]);
+    center.x += 0.25f * vertices[k].x;
+    center.y += 0.25f * vertices[k].y;
+    center.z += 0.25f * vertices[k].z;
+  }
+
+  for (const auto &triangle : TETHRAEDRON) {
+    const Index f = newFacet();
+    auto &facet = facets[f];
+    facet.vertices = {triangle[0], triangle[1], triangle[2]};
+    setNormal(facet);
+    hull::Coordinate delta;
+    hull::diff(delta, center, vertices[triangle[0]]);
+    if (0 < hull::dot(delta, facet.normal)) {
+      std::swap(facet.vertices[1], facet.vertices[2]);
+      setNormal(facet);
+    }
+  }
+  inner_point = center;
+  beginBatch();
+
+  // each edge is shared with the facet having it in the opposite direction
+  for (Index f = 0; f < 4; ++f) {
+    auto &facet = facets[f];
+    for (std::size_t e = 0; e < 3; ++e) {
+      const Index from = facet.vertices[e];
+      const Index to = facet.vertices[(e + 1) % 3];
+      for (Index g = 0; g < 4; ++g) {
+        const auto &other = facets[g];
+        for (std::size_t k = 0; k < 3; ++k) {
+          if ((other.vertices[k] == to) &&
+              (other.vertices[(k + 1) % 3] == from)) {
+            facet.neighbours[e] = g;
+          }
+        }
+      }
+    }
+    last_update.added.push_back(f);
+  }
+}
+
+Mesh::Index Mesh::findMostVisible(const hull::Coordinate &point,
+                                  Index start) const {
+  // In the polar dual of the hull w.r.t. the inner point, the facets are
+  // vertices, adjacent when the facets are neighbours, and the relative
+  // distance is a linear function of them: a local maximum is the global one.
+  // Ties, as for coplanar facets, are crossed without visiting a facet twice.
+  hull::Coordinate direction;
+  hull::diff(direction, point, inner_point);
+  auto relative_distance = [&](Index f) {
+    const auto &facet = facets[f];
+    hull::Coordinate depth;
+    hull::diff(depth, vertices[facet.vertices[0]], inner_point);
+    return hull::dot(direction, facet.normal) /
+           hull::dot(depth, facet.normal);
+  };
+  plateau.clear();
+  Index current = start;
+  float best = relative_distance(start);
+  plateau.push_back(start);
+  while (true) {
+    Index next = NONE;
+    float next_distance = best;
+    for (const auto neighbour : facets[current].neighbours) {
+      const float candidate = relative_distance(neighbour);
+      if ((next_distance < candidate) ||
+          ((next == NONE) && (candidate == best) &&
+           (std::find(plateau.begin(), plateau.end(), neighbour) ==
+            plateau.end()))) {
+        next = neighbour;
+        next_distance = candidate;
+      }
+    }
+    if (next == NONE) {
+      break;
+    }
+    if (best < next_distance) {
+      plateau.clear();
+    }
+    plateau.push_back(next);
+    best = next_distance;
+    current = next;
+  }
+  return current;
+}
+
+void Mesh::beginBatch() {
+  if (++batch == 0) {
+    std::fill(created_in.begin(), created_in.end(), 0);
+    batch = 1;
+  }
+}
+
+bool Mesh::update(const hull::Coordinate &vertex, std::size_t cloud_index,
+                  Index visible_facet) {
+  last_update.changed.clear();
+  last_update.added.clear();
+  last_update.removed.clear();
+
+  if (marks.size() < facets.size()) {
+    marks.resize(facets.size(), 0);
+  }
+  if (created_in.size() < facets.size()) {
+    created_in.resize(facets.size(), 0);
+  }
+  if (++epoch == 0) {
+    std::fill(marks.begin(), marks.end(), 0);
+    epoch = 1;
+  }
+  auto is_visible = [&](const Facet &facet) {
+    hull::Coordinate delta;
+    hull::diff(delta, vertex, vertices[facet.vertices[0]]);
+    return 0 < hull::dot(delta, facet.normal);
+  };
+
+  // the visible region is explored breadth first, collecting the edges
+  // separating it from the rest of the hull
+  visible.clear();
+  horizon.clear();
+  marks[visible_facet] = epoch;
+  visible.push_back(visible_facet);
+  for (std::size_t v = 0; v < visible.size(); ++v) {
+    const Index f = visible[v];
+    const auto &facet = facets[f];
+    for (std::uint8_t e = 0; e < 3; ++e) {
+      const Index neighbour = facet.neighbours[e];
+      if (marks[neighbour] == epoch) {
+        continue;
+      }
+      if (is_visible(facets[neighbour])) {
+        marks[neighbour] = epoch;
+        visible.push_back(neighbour);
+        continue;
+      }
+      horizon.push_back(HorizonEdge{facet.vertices[e],
+                                    facet.vertices[(e + 1) % 3], neighbour,
+                                    find_edge(facets[neighbour], f), NONE});
+    }
+  }
+  for (const auto f : visible) {
+    if (created_in[f] == batch) {
+      return false;
+    }
+  }
+
+  // the slots of the visible facets are reused by the cone of new ones, any
+  // other one needed is taken from the free ones
+  const Index apex = addVertex(vertex, cloud_index);
+  if (starting_at.size() < vertices.size()) {
+    starting_at.resize(vertices.size());
+    ending_at.resize(vertices.size());
+  }
+  for (std::size_t h = 0; h < horizon.size(); ++h) {
+    auto &edge = horizon[h];
+    if (h < visible.size()) {
+      edge.facet = visible[h];
+      last_update.changed.push_back(edge.facet);
+    } else {
+      edge.facet = newFacet();
+      last_update.added.push_back(edge.facet);
+      if (created_in.size() <= edge.facet) {
+        created_in.resize(facets.size(), 0);
+      }
+    }
+    created_in[edge.facet] = batch;
+    starting_at[edge.from] = edge.facet;
+    ending_at[edge.to] = edge.facet;
+  }
+  for (std::size_t v = horizon.size(); v < visible.size(); ++v) {
+    facets[visible[v]].vertices[0] = NONE;
+    free_facets.push_back(visible[v]);
+    last_update.removed.push_back(visible[v]);
+  }
+
+  for (const auto &edge : horizon) {
+    auto &facet = facets[edge.facet];
+    facet.vertices = {edge.from, edge.to, apex};
+    facet.neighbours = {edge.outside, starting_at[edge.to],
+                        ending_at[edge.from]};
+    setNormal(facet);
+    facets[edge.outside].neighbours[edge.outside_edge] = edge.facet;
+  }
+  return true;
+}
+} // namespace qh
@@ -0,0 +1,148 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <Hull/Coordinate.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace qh {
+// The triangulated surface of the convex hull under construction.
+// Facets and vertices are stored in contiguous arrays and refer to each other
+// by 32 bits indices: each facet knows the facets sharing its edges, so that
+// the ones visible from a new vertex are found by walking the surface. The
+// slots of the removed facets are recycled by the next updates.
+// All the buffers are kept from one computation to the next one.
+class Mesh {
+public:
+  using Index = std::uint32_t;
+  static constexpr Index NONE = std::numeric_limits<Index>::max();
+
+  struct Facet {
+    // counter clockwise when seen from outside the hull. vertices[0] is NONE
+    // for the slots not in use.
+    std::array<Index, 3> vertices;
+    // neighbours[k] is the facet sharing the edge from vertices[k] to
+    // vertices[(k + 1) % 3]
+    std::array<Index, 3> neighbours;
+    // outgoing and normalized
+    hull::Coordinate normal;
+  };
+
+  // the facets modified by the last reset or update
+  struct Update {
+    // slots of the removed facets reused by new ones
+    std::vector<Index> changed;
+    std::vector<Index> added;
+    std::vector<Index> removed;
+  };
+
+  // Forgets the previous surface and starts a new one, made by the
+  // tethraedron having the passed vertices, which should not be coplanar.
+  // cloud_indices are the positions of the vertices in the point cloud.
+  void reset(const std::array<hull::Coordinate, 4> &vertices,
+             const std::array<std::size_t, 4> &cloud_indices);
+
+  // Adds a vertex outside the hull, replacing the facets it sees with a cone
+  // of facets connecting it to the horizon. visible_facet should be one of
+  // the facets in front of vertex, from which the visible region is explored.
+  // Returns false, leaving the surface untouched, when vertex sees a facet
+  // created by a previous update of the current batch.
+  bool update(const hull::Coordinate &vertex, std::size_t cloud_index,
+              Index visible_facet);
+
+  // Starts a new batch of updates: the regions replaced by the updates of
+  // the same batch don't overlap.
+  void beginBatch();
+
+  // Walks the surface from start, looking for the facet maximizing the
+  // distance of point from its plane, relative to the distance of the inner
+  // point of the hull: it is in front of point, if any facet is.
+  Index findMostVisible(const hull::Coordinate &point, Index start) const;
+
+  const Update &getLastUpdate() const { return last_update; }
+
+  // the number of facets slots, including the ones not in use
+  std::size_t facetsCapacity() const { return facets.size(); }
+
+  std::size_t size() const { return facets.size() - free_facets.size(); }
+
+  std::size_t verticesSize() const { return vertices.size(); }
+
+  bool isInUse(Index facet) const { return facets[facet].vertices[0] != NONE; }
+
+  const Facet &getFacet(Index facet) const { return facets[facet]; }
+
+  const hull::Coordinate &getVertex(Index vertex) const {
+    return vertices[vertex];
+  }
+
+  std::size_t getCloudIndex(Index vertex) const {
+    return cloud_indices[vertex];
+  }
+
+  // pred(facet_index, facet) is called for all the facets in use
+  template <typename Pred> void forEachFacet(const Pred &pred) const {
+    for (Index f = 0; f < facets.size(); ++f) {
+      if (isInUse(f)) {
+        pred(f, facets[f]);
+      }
+    }
+  }
+
+private:
+  Index addVertex(const hull::Coordinate &vertex, std::size_t cloud_index);
+
+  Index newFacet();
+
+  void setNormal(Facet &facet) const;
+
+  std::vector<hull::Coordinate> vertices;
+  // center of the initial tethraedron, which stays inside the hull
+  hull::Coordinate inner_point;
+  // the position in the point cloud of each vertex
+  std::vector<std::size_t> cloud_indices;
+
+  std::vector<Facet> facets;
+  std::vector<Index> free_facets;
+
+  Update last_update;
+
+  // buffers of update
+  // a facet is part of the visible region of the current update when its
+  // mark is equal to the current epoch
+  std::vector<std::uint32_t> marks;
+  std::uint32_t epoch = 0;
+  std::vector<Index> visible;
+  // the batch during which each facet was created
+  std::vector<std::uint32_t> created_in;
+  std::uint32_t batch = 0;
+  struct HorizonEdge {
+    Index from;
+    Index to;
+    // the facet not visible sharing the edge
+    Index outside;
+    // the position of the edge in outside
+    std::uint8_t outside_edge;
+    // the new facet connecting the edge to the new vertex
+    Index facet;
+  };
+  std::vector<HorizonEdge> horizon;
+  // for each vertex of the horizon, the new facet whose horizon edge starts
+  // (ends) with it
+  std::vector<Index> starting_at;
+  std::vector<Index> ending_at;
+
+  // buffer of findMostVisible: the facets having the same relative distance
+  // as the current one, already visited
+  mutable std::vector<Index> plateau;
+};
+} // namespace qh
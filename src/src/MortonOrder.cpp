@@ -0,0 +1,103 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include "MortonOrder.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace qh {
+namespace {
+// each coordinate is quantized into 2^10 cells, spanning the bounding box
+static constexpr std::uint32_t CELLS_PER_AXIS = 1 << 10;
+// the 30 bits codes are sorted in 2 passes of 15 bits each
+static constexpr std::uint32_t RADIX_BITS = 15;
+static constexpr std::uint32_t RADIX = 1 << RADIX_BITS;
+// the counters of a radix sort pass are not worth clearing for fewer points
+static constexpr std::size_t MIN_RADIX_SORT_SIZE = 1 << 12;
+
+// the 10 bits of value spread over the positions multiple of 3
+std::uint32_t spread_bits(std::uint32_t value) {
+  value = (value | (value << 16)) & 0x030000FF;
+  value = (value | (value << 8)) & 0x0300F00F;
+  value = (value | (value << 4)) & 0x030C30C3;
+  value = (value | (value << 2)) & 0x09249249;
+  return value;
+}
+} // namespace
+
+template <typename Scalar>
+const std::vector<std::size_t> &
+MortonOrder<Scalar>::sort(const BasicPointsView<Scalar> &points) {
+  order.resize(points.size);
+  std::iota(order.begin(), order.end(), 0);
+  if (points.size == 0) {
+    return order;
+  }
+
+  Scalar min[3] = {points.data[0], points.data[1], points.data[2]};
+  Scalar max[3] = {points.data[0], points.data[1], points.data[2]};
+  for (std::size_t k = 0; k < points.size; ++k) {
+    const Scalar *point = points.data + k * points.stride;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      min[axis] = std::min(min[axis], point[axis]);
+      max[axis] = std::max(max[axis], point[axis]);
+    }
+  }
+  Scalar scale[3];
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    const Scalar extent = max[axis] - min[axis];
+    scale[axis] = (extent > 0) ? static_cast<Scalar>(CELLS_PER_AXIS) / extent
+                               : static_cast<Scalar>(0);
+  }
+
+  codes.resize(points.size);
+  for (std::size_t k = 0; k < points.size; ++k) {
+    const Scalar *point = points.data + k * points.stride;
+    std::uint32_t code = 0;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      const auto cell = std::min<std::uint32_t>(
+          CELLS_PER_AXIS - 1,
+          static_cast<std::uint32_t>((point[axis] - min[axis]) * scale[axis]));
+      code |= spread_bits(cell) << axis;
+    }
+    codes[k] = code;
+  }
+
+  if (points.size < MIN_RADIX_SORT_SIZE) {
+    std::stable_sort(order.begin(), order.end(),
+                     [this](std::size_t a, std::size_t b) {
+                       return codes[a] < codes[b];
+                     });
+    return order;
+  }
+
+  // least significant digit radix sort, stable as the original order is
+  // kept among the points with the same code
+  codes_buffer.resize(points.size);
+  order_buffer.resize(points.size);
+  for (std::uint32_t shift = 0; shift < 2 * RADIX_BITS; shift += RADIX_BITS) {
+    counters.assign(RADIX + 1, 0);
+    for (const auto code : codes) {
+      ++counters[((code >> shift) & (RADIX - 1)) + 1];
+    }
+    std::partial_sum(counters.begin(), counters.end(), counters.begin());
+    for (std::size_t k = 0; k < points.size; ++k) {
+      const std::size_t position =
+          counters[(codes[k] >> shift) & (RADIX - 1)]++;
+      codes_buffer[position] = codes[k];
+      order_buffer[position] = order[k];
+    }
+    codes.swap(codes_buffer);
+    order.swap(order_buffer);
+  }
+  return order;
+}
+
+template class MortonOrder<float>;
+template class MortonOrder<double>;
+} // namespace qh
@@ -0,0 +1,35 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace qh {
+// Sorts the points of a cloud along a Z-order (Morton) curve spanning their
+// bounding box, so that the points close in space get close positions.
+// The buffers are kept from one sort to the next one.
+// Explicitly instantiated for float and double.
+template <typename Scalar> class MortonOrder {
+public:
+  // The returned element in position k is the position in points of the
+  // k-th point along the curve. The reference is valid until the next sort.
+  const std::vector<std::size_t> &sort(const BasicPointsView<Scalar> &points);
+
+private:
+  // the key of each point and its position in the cloud, in the order of the
+  // current radix sort pass, and a buffer for the next one
+  std::vector<std::uint32_t> codes;
+  std::vector<std::uint32_t> codes_buffer;
+  std::vector<std::size_t> order;
+  std::vector<std::size_t> order_buffer;
+  std::vector<std::size_t> counters;
+};
+} // namespace qh
@@ -0,0 +1,39 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include "DistanceMapper.h"
+#include "MassProperties.h"
+#include "Mesh.h"
+
+#include <optional>
+#include <vector>
+
+namespace qh {
+// The buffers used to compute a convex hull with a certain precision, reused
+// from one computation to the next one
+template <typename Scalar> struct Pipeline {
+  PointCloud<Scalar> cloud;
+  Mesh mesh;
+  DistanceMapper<Scalar> mapper{cloud, mesh};
+  MassAccumulator mass;
+};
+
+// Computes the convex hull of points, with the Quick Hull algorithm.
+// max_tolerance bounds the tolerance computed from the bounding box of the
+// points. Explicitly instantiated for float and double.
+template <typename Scalar>
+void compute_hull(Pipeline<Scalar> &pipeline,
+                  const BasicPointsView<Scalar> &points,
+                  const ConvexHullContext &cntx,
+                  std::vector<FacetIncidences> &incidences,
+                  std::vector<hull::Coordinate> &normals,
+                  std::optional<Scalar> max_tolerance = std::nullopt);
+} // namespace qh
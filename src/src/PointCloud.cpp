@@ -3,164 +3,512 @@
 
 #include "Definitions.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
 namespace qh {
-PointCloud::PointCloud(const std::vector<hull::Coordinate> &points)
-    : points(points) {
-  if (points.size() < 4) {
+namespace {
+template <typename Scalar>
+void check_stride(const BasicPointsView<Scalar> &points) {
+  if (points.stride < 3) {
+    throw Error{"The stride of the points should be at least 3"};
+  }
+}
+} // namespace
+
+template <typename Scalar>
+PointCloud<Scalar>::PointCloud(const BasicPointsView<Scalar> &points) {
+  reset(points);
+}
+
+template <typename Scalar>
+void PointCloud<Scalar>::reset(const BasicPointsView<Scalar> &points,
+                               bool spatial_sort) {
+  if (points.size < 4) {
     throw Error{"The point cloud should have at least 4 points"};
   }
-  for (std::size_t k = 0; k < points.size(); ++k) {
-    open_set[&points[k]] = k;
+  x.clear();
+  y.clear();
+  z.clear();
+  open_set.clear();
+  extremes.clear();
+  permutation.clear();
+  if (!spatial_sort) {
+    append(points);
+    return;
+  }
+  check_stride(points);
+  permutation = morton_order.sort(points);
+  open_set.resize(points.size, 1);
+  x.resize(points.size);
+  y.resize(points.size);
+  z.resize(points.size);
+  for (std::size_t k = 0; k < points.size; ++k) {
+    const Scalar *point = points.data + permutation[k] * points.stride;
+    x[k] = point[0];
+    y[k] = point[1];
+    z[k] = point[2];
   }
 }
 
-namespace {
-float get_vertex_distance(const hull::Coordinate &facet_point,
-                          const hull::Coordinate &facet_normal,
-                          const hull::Coordinate &vertex) {
-  hull::Coordinate diff;
-  hull::diff(diff, vertex, facet_point);
-  return hull::dot(diff, facet_normal);
+template <typename Scalar>
+void PointCloud<Scalar>::append(const BasicPointsView<Scalar> &points) {
+  check_stride(points);
+  const std::size_t offset = size();
+  if (!permutation.empty()) {
+    for (std::size_t k = 0; k < points.size; ++k) {
+      permutation.push_back(offset + k);
+    }
+  }
+  open_set.resize(offset + points.size, 1);
+  x.resize(offset + points.size);
+  y.resize(offset + points.size);
+  z.resize(offset + points.size);
+  const Scalar *point = points.data;
+  for (std::size_t k = offset; k < size(); ++k, point += points.stride) {
+    x[k] = point[0];
+    y[k] = point[1];
+    z[k] = point[2];
+  }
 }
-} // namespace
 
-std::optional<PointCloud::FarthestVertex>
-PointCloud::getFarthest(const hull::Coordinate &point_on_facet,
-                        const hull::Coordinate &facet_normal) const {
-  PointCloud::FarthestVertex result =
-      PointCloud::FarthestVertex{0, QHULL_GEOMETRIC_TOLLERANCE};
-  float distance;
-  for (auto [point, pos] : open_set) {
-    distance = get_vertex_distance(point_on_facet, facet_normal, *point);
-    if (result.distance < distance) {
-      result.distance = distance;
-      result.vertex = pos;
-    }
+template <typename Scalar>
+void PointCloud<Scalar>::fitBoundingBox(std::optional<Scalar> max_tolerance) {
+  if (x.empty()) {
+    return;
   }
-  if (result.distance == QHULL_GEOMETRIC_TOLLERANCE) {
+  const auto [min_x, max_x] = std::minmax_element(x.begin(), x.end());
+  const auto [min_y, max_y] = std::minmax_element(y.begin(), y.end());
+  const auto [min_z, max_z] = std::minmax_element(z.begin(), z.end());
+  const Scalar min[3] = {*min_x, *min_y, *min_z};
+  const Scalar max[3] = {*max_x, *max_y, *max_z};
+  center = Vector3<Scalar>{(min[0] + max[0]) / 2, (min[1] + max[1]) / 2,
+                           (min[2] + max[2]) / 2};
+  extent = std::max({max[0] - min[0], max[1] - min[1], max[2] - min[2]});
+  tolerance = box_tolerance(min, max);
+  if (max_tolerance.has_value()) {
+    tolerance = std::min(tolerance, *max_tolerance);
+  }
+}
+
+template <typename Scalar>
+std::optional<typename PointCloud<Scalar>::FarthestVertex>
+PointCloud<Scalar>::getFarthest(
+    const hull::Coordinate &point_on_facet,
+    const hull::Coordinate &facet_normal,
+    const std::vector<std::size_t> &outside_set) const {
+  if (outside_set.empty()) {
     return std::nullopt;
   }
-  return result;
+  // The vertices in outside_set were already found in front of the facet by
+  // isInFront. The SIMD kernels, fusing the multiply-adds, may see one of
+  // them right at the tolerance: checking it again would leave it stuck in
+  // a facet that never gets expanded.
+  auto result = get_kernels<Scalar>().farthest_in_subset(
+      coordinates(), outside_set.data(), outside_set.size(),
+      toCloudFrame(point_on_facet),
+      Vector3<Scalar>{facet_normal.x, facet_normal.y, facet_normal.z},
+      std::numeric_limits<Scalar>::lowest());
+  return FarthestVertex{result.index, result.value};
+}
+
+template <typename Scalar>
+bool PointCloud<Scalar>::isInFront(const hull::Coordinate &point_on_facet,
+                                   const hull::Coordinate &facet_normal,
+                                   std::size_t index) const {
+  const auto point = toCloudFrame(point_on_facet);
+  Scalar distance = (x[index] - point.x) * facet_normal.x +
+                    (y[index] - point.y) * facet_normal.y +
+                    (z[index] - point.z) * facet_normal.z;
+  return tolerance < distance;
 }
 
 namespace {
-template <typename DistanceComputation>
-std::size_t
-farthest_to_subject(const std::vector<hull::Coordinate> &points,
-                    const DistanceComputation &squared_distance_to_subject) {
-  float max_distance = QHULL_GEOMETRIC_TOLLERANCE_SQUARED;
-  std::size_t result = 0;
-  float squared_distance;
-  for (std::size_t k = 0; k < points.size(); ++k) {
-    squared_distance = squared_distance_to_subject(points[k]);
-    if (max_distance < squared_distance) {
-      result = k;
-      max_distance = squared_distance;
-    }
-  }
-  if (max_distance == QHULL_GEOMETRIC_TOLLERANCE_SQUARED) {
+template <typename Scalar>
+std::size_t farthest_to_subject(const Kernels<Scalar> &kernels,
+                                const CoordinatesSoA<Scalar> &cloud,
+                                std::size_t cloud_size,
+                                const QuadraticDistance<Scalar> &distance,
+                                Scalar threshold) {
+  auto result =
+      kernels.farthest_in_cloud(cloud, cloud_size, distance, threshold);
+  if (result.value == threshold) {
     throw Error{"The passed cloud has null volume"};
   }
+  return result.index;
+}
+
+template <typename Scalar>
+Vector3<Scalar> delta(const Vector3<Scalar> &v1, const Vector3<Scalar> &v2) {
+  return Vector3<Scalar>{v1.x - v2.x, v1.y - v2.y, v1.z - v2.z};
+}
+
+template <typename Scalar>
+Scalar dot(const Vector3<Scalar> &a, const Vector3<Scalar> &b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+template <typename Scalar>
+Vector3<Scalar> normalized(const Vector3<Scalar> &subject) {
+  Scalar norm = std::sqrt(dot(subject, subject));
+  return Vector3<Scalar>{subject.x / norm, subject.y / norm, subject.z / norm};
+}
+
+template <typename Scalar>
+Vector3<Scalar> cross(const Vector3<Scalar> &a, const Vector3<Scalar> &b) {
+  return Vector3<Scalar>{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+                         a.x * b.y - a.y * b.x};
+}
+
+template <typename Scalar>
+QuadraticDistance<Scalar> distance_to_point(const Vector3<Scalar> &a) {
+  return QuadraticDistance<Scalar>{a, 1, Vector3<Scalar>{0, 0, 0}, 0};
+}
+
+// |p - a|^2 - <p - a, u>^2, with u the versor of the line
+template <typename Scalar>
+QuadraticDistance<Scalar> distance_to_line(const Vector3<Scalar> &a,
+                                           const Vector3<Scalar> &b) {
+  return QuadraticDistance<Scalar>{a, 1, normalized(delta(b, a)), -1};
+}
+
+// <p - a, n>^2, with n the normal of the plane
+template <typename Scalar>
+QuadraticDistance<Scalar> distance_to_plane(const Vector3<Scalar> &a,
+                                            const Vector3<Scalar> &b,
+                                            const Vector3<Scalar> &c) {
+  return QuadraticDistance<Scalar>{
+      a, 0, normalized(cross(delta(b, a), delta(c, a))), 1};
+}
+} // namespace
+
+namespace {
+template <typename Scalar>
+std::vector<Vector3<Scalar>> culling_directions(InteriorCulling kind) {
+  std::vector<Vector3<Scalar>> axes = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+  if (kind != InteriorCulling::DOP_6) {
+    axes.insert(axes.end(),
+                {{1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {-1, 1, 1}});
+  }
+  if (kind == InteriorCulling::DOP_26) {
+    axes.insert(axes.end(), {{1, 1, 0},
+                             {1, -1, 0},
+                             {1, 0, 1},
+                             {1, 0, -1},
+                             {0, 1, 1},
+                             {0, 1, -1}});
+  }
+  std::vector<Vector3<Scalar>> result;
+  for (const auto &axis : axes) {
+    result.push_back(axis);
+    result.push_back(Vector3<Scalar>{-axis.x, -axis.y, -axis.z});
+  }
   return result;
 }
 
-hull::Coordinate delta(const hull::Coordinate &v1, const hull::Coordinate &v2) {
-  hull::Coordinate result;
-  hull::diff(result, v1, v2);
+// The planes passing by 3 of the passed vertices, leaving all the other ones
+// behind: they are the facets of the convex hull of the vertices, possibly
+// repeated when more than 3 vertices lie on the same facet. Brute force is
+// fine, as there are at most 26 vertices.
+template <typename Scalar>
+std::vector<Plane<Scalar>>
+supporting_planes(const std::vector<Vector3<Scalar>> &vertices,
+                  Scalar tolerance) {
+  std::vector<Plane<Scalar>> result;
+  auto add_plane = [&](const Vector3<Scalar> &normal, Scalar offset) {
+    for (const auto &plane : result) {
+      if ((static_cast<Scalar>(1 - 1e-5) < dot(plane.normal, normal)) &&
+          (std::abs(plane.offset - offset) < tolerance)) {
+        return;
+      }
+    }
+    result.emplace_back(Plane<Scalar>{normal, offset});
+  };
+  const std::size_t size = vertices.size();
+  for (std::size_t a = 0; a < size; ++a) {
+    for (std::size_t b = a + 1; b < size; ++b) {
+      for (std::size_t c = b + 1; c < size; ++c) {
+        Vector3<Scalar> normal = cross(delta(vertices[b], vertices[a]),
+                                       delta(vertices[c], vertices[a]));
+        Scalar norm = std::sqrt(dot(normal, normal));
+        if (norm < tolerance * tolerance) {
+          continue;
+        }
+        normal =
+            Vector3<Scalar>{normal.x / norm, normal.y / norm, normal.z / norm};
+        const Scalar offset = dot(normal, vertices[a]);
+        bool all_behind = true, all_in_front = true;
+        for (const auto &vertex : vertices) {
+          Scalar distance = dot(normal, vertex) - offset;
+          all_behind = all_behind && (distance < tolerance);
+          all_in_front = all_in_front && (-tolerance < distance);
+        }
+        if (all_behind) {
+          add_plane(normal, offset);
+        }
+        if (all_in_front) {
+          add_plane(Vector3<Scalar>{-normal.x, -normal.y, -normal.z}, -offset);
+        }
+      }
+    }
+  }
   return result;
 }
+} // namespace
+
+namespace {
+// the cloud is scanned along all the directions one block at a time, while
+// the block is still in cache
+static constexpr std::size_t CULLING_BLOCK_SIZE = 4096;
+
+template <typename Scalar>
+bool is_better(const ArgMax<Scalar> &candidate,
+               const ArgMax<Scalar> &subject) {
+  return (subject.value < candidate.value) ||
+         ((subject.value == candidate.value) &&
+          (candidate.index < subject.index));
+}
 
-void add(hull::Coordinate &subject, const hull::Coordinate &to_add,
-         float to_add_coeff) {
-  subject.x += to_add_coeff * to_add.x;
-  subject.y += to_add_coeff * to_add.y;
-  subject.z += to_add_coeff * to_add.z;
+// task(begin, end) is called on [0, size), splitting the range among the
+// threads of the pool only if it is big enough
+void for_each_chunk(std::size_t size, ThreadPool *pool,
+                    std::size_t parallel_threshold,
+                    const ThreadPool::Task &task) {
+  if ((pool == nullptr) || (size < parallel_threshold)) {
+    task(0, size);
+    return;
+  }
+  pool->parallelFor(size, task);
 }
 
-class DistanceToSegment {
-public:
-  DistanceToSegment(const hull::Coordinate &a, const hull::Coordinate &b)
-      : a(a) {
-    ba_delta = delta(b, a);
-    ba_delta_dot = hull::dot(ba_delta, ba_delta);
+// Fibonacci lattice: the directions are evenly spread over the unit sphere
+template <typename Scalar>
+std::vector<Vector3<Scalar>> sphere_directions(std::size_t size) {
+  // pi * (3 - sqrt(5))
+  const double golden_angle = 2.399963229728653;
+  std::vector<Vector3<Scalar>> result;
+  result.reserve(size);
+  for (std::size_t k = 0; k < size; ++k) {
+    const double z = 1.0 - (2.0 * k + 1.0) / static_cast<double>(size);
+    const double radius = std::sqrt(1.0 - z * z);
+    const double angle = golden_angle * static_cast<double>(k);
+    result.push_back(Vector3<Scalar>{
+        static_cast<Scalar>(radius * std::cos(angle)),
+        static_cast<Scalar>(radius * std::sin(angle)), static_cast<Scalar>(z)});
   }
+  return result;
+}
+} // namespace
 
-  float operator()(const hull::Coordinate &point) const {
-    float s = hull::dot(delta(point, a), ba_delta) / ba_delta_dot;
-    hull::Coordinate result = delta(a, point);
-    add(result, ba_delta, s);
-    return hull::dot(result, result);
+template <typename Scalar>
+void PointCloud<Scalar>::findExtremes(
+    const std::vector<Vector3<Scalar>> &directions, ThreadPool *pool,
+    std::size_t parallel_threshold) {
+  const auto &kernels = get_kernels<Scalar>();
+  const auto soa = coordinates();
+  const ArgMax<Scalar> no_extreme{0, std::numeric_limits<Scalar>::lowest()};
+  std::vector<ArgMax<Scalar>> best(directions.size(), no_extreme);
+  std::mutex best_mtx;
+  auto scan = [&](std::size_t begin, std::size_t end) {
+    std::vector<ArgMax<Scalar>> local(directions.size(), no_extreme);
+    for (std::size_t block = begin; block < end; block += CULLING_BLOCK_SIZE) {
+      const std::size_t block_size = std::min(CULLING_BLOCK_SIZE, end - block);
+      CoordinatesSoA<Scalar> block_soa{soa.x + block, soa.y + block,
+                                       soa.z + block};
+      for (std::size_t d = 0; d < directions.size(); ++d) {
+        auto candidate = kernels.farthest_along_direction(
+            block_soa, block_size, directions[d]);
+        candidate.index += block;
+        if (is_better(candidate, local[d])) {
+          local[d] = candidate;
+        }
+      }
+    }
+    std::scoped_lock lock(best_mtx);
+    for (std::size_t d = 0; d < directions.size(); ++d) {
+      if (is_better(local[d], best[d])) {
+        best[d] = local[d];
+      }
+    }
   };
+  for_each_chunk(size(), pool, parallel_threshold, scan);
 
-private:
-  hull::Coordinate a;
-  hull::Coordinate ba_delta;
-  float ba_delta_dot;
-};
-
-class DistanceToPlane {
-public:
-  DistanceToPlane(const hull::Coordinate &a, const hull::Coordinate &b,
-                  const hull::Coordinate &c)
-      : a(a) {
-    ba_delta = delta(b, a);
-    ba_delta_dot = hull::dot(ba_delta, ba_delta);
-    ca_delta = delta(c, a);
-    ca_delta_dot = hull::dot(ca_delta, ca_delta);
-    mixed_dot = hull::dot(ca_delta, ba_delta);
-  }
-
-  float operator()(const hull::Coordinate &point) const {
-    auto pa_delta = delta(point, a);
-    float c1 = hull::dot(pa_delta, ba_delta);
-    float c2 = hull::dot(pa_delta, ca_delta);
-
-    float beta = (mixed_dot * c2 - ca_delta_dot * c1) /
-                 (mixed_dot * mixed_dot - ba_delta_dot * ca_delta_dot);
-    float gamma = (c1 - beta * ba_delta_dot) / mixed_dot;
-
-    hull::Coordinate result = delta(a, point);
-    add(result, ba_delta, beta);
-    add(result, ca_delta, gamma);
-    return hull::dot(result, result);
-  }
-
-private:
-  hull::Coordinate a;
-  hull::Coordinate ba_delta;
-  float ba_delta_dot;
-  hull::Coordinate ca_delta;
-  float ca_delta_dot;
-  float mixed_dot;
-};
-} // namespace
+  extremes.clear();
+  for (const auto &extreme : best) {
+    extremes.push_back(extreme.index);
+  }
+  std::sort(extremes.begin(), extremes.end());
+  extremes.erase(std::unique(extremes.begin(), extremes.end()),
+                 extremes.end());
+}
 
-std::array<std::size_t, 4> PointCloud::getInitialTethraedron() const {
-  std::array<std::size_t, 4> result;
-  result[0] = 0;
+template <typename Scalar>
+std::size_t
+PointCloud<Scalar>::cullInteriorPoints(InteriorCulling kind, ThreadPool *pool,
+                                       std::size_t parallel_threshold) {
+  extremes.clear();
+  if (kind == InteriorCulling::NONE) {
+    return 0;
+  }
+  findExtremes(culling_directions<Scalar>(kind), pool, parallel_threshold);
 
-  result[1] = farthest_to_subject(points, [&subject = points[result.front()]](
-                                              const hull::Coordinate &point) {
-    return hull::squaredDistance(subject, point);
-  });
+  // far away from the origin, planes in absolute coordinates would carry a
+  // rounding error comparable to the tolerance: both the planes and the
+  // inside test are expressed w.r.t. the center
+  std::vector<Vector3<Scalar>> polytope;
+  for (const auto index : extremes) {
+    polytope.push_back(delta(getVector(index), center));
+  }
+  const auto planes = supporting_planes(polytope, tolerance);
+  if (planes.size() < 4) {
+    // flat polytope: nothing is strictly inside
+    return 0;
+  }
+  return closeInside(planes, pool, parallel_threshold);
+}
+
+template <typename Scalar>
+std::size_t
+PointCloud<Scalar>::closeInside(const std::vector<Plane<Scalar>> &planes,
+                                ThreadPool *pool,
+                                std::size_t parallel_threshold) {
+  const auto &kernels = get_kernels<Scalar>();
+  const auto soa = coordinates();
+  std::atomic_size_t closed = 0;
+  for_each_chunk(size(), pool, parallel_threshold,
+                 [&](std::size_t begin, std::size_t end) {
+                   CoordinatesSoA<Scalar> chunk{soa.x + begin, soa.y + begin,
+                                                soa.z + begin};
+                   closed += kernels.close_inside_polytope(
+                       chunk, end - begin, planes.data(), planes.size(),
+                       center, tolerance, open_set.data() + begin);
+                 });
+  return closed;
+}
 
-  {
-    DistanceToSegment segment_operator(points[result[0]], points[result[1]]);
-    result[2] = farthest_to_subject(
-        points, [&segment_operator](const hull::Coordinate &point) {
-          return segment_operator(point);
-        });
+template <typename Scalar>
+std::size_t PointCloud<Scalar>::keepCoreset(std::size_t directions,
+                                            ThreadPool *pool,
+                                            std::size_t parallel_threshold) {
+  findExtremes(sphere_directions<Scalar>(directions), pool,
+               parallel_threshold);
+  std::fill(open_set.begin(), open_set.end(), 0);
+  for (const auto index : extremes) {
+    open_set[index] = 1;
   }
+  return size() - extremes.size();
+}
 
-  {
-    DistanceToPlane plane_operator(points[result[0]], points[result[1]],
-                                   points[result[2]]);
-    result[3] = farthest_to_subject(
-        points, [&plane_operator](const hull::Coordinate &point) {
-          return plane_operator(point);
-        });
+template <typename Scalar>
+std::vector<std::size_t>
+PointCloud<Scalar>::reopenOutside(const std::vector<Plane<Scalar>> &planes,
+                                  ThreadPool *pool,
+                                  std::size_t parallel_threshold) {
+  std::fill(open_set.begin(), open_set.end(), 1);
+  closeInside(planes, pool, parallel_threshold);
+  std::vector<std::size_t> result;
+  for (std::size_t k = 0; k < size(); ++k) {
+    if (isOpen(k)) {
+      result.push_back(k);
+    }
   }
+  return result;
+}
+
+template <typename Scalar>
+Plane<Scalar>
+PointCloud<Scalar>::getPlane(const hull::Coordinate &point,
+                             const hull::Coordinate &normal) const {
+  const Vector3<Scalar> direction{normal.x, normal.y, normal.z};
+  // point is already expressed w.r.t. the center, as closeInside expects
+  const Vector3<Scalar> relative{point.x, point.y, point.z};
+  return Plane<Scalar>{direction, dot(direction, relative)};
+}
+
+template <typename Scalar>
+std::array<std::size_t, 4> PointCloud<Scalar>::getInitialTethraedron() const {
+  const auto &kernels = get_kernels<Scalar>();
+  const auto soa = coordinates();
+  const Scalar threshold = tolerance * tolerance;
+
+  std::array<std::size_t, 4> result;
+  // when available, start from a point surely on the hull
+  result[0] = extremes.empty() ? 0 : extremes.front();
+
+  result[1] = farthest_to_subject(
+      kernels, soa, size(), distance_to_point(getVector(result[0])), threshold);
+
+  result[2] = farthest_to_subject(
+      kernels, soa, size(),
+      distance_to_line(getVector(result[0]), getVector(result[1])), threshold);
+
+  result[3] = farthest_to_subject(kernels, soa, size(),
+                                  distance_to_plane(getVector(result[0]),
+                                                    getVector(result[1]),
+                                                    getVector(result[2])),
+                                  threshold);
 
   return result;
 }
+
+template <typename Scalar>
+Scalar PointCloud<Scalar>::distanceToTriangle(std::size_t index,
+                                              const hull::Coordinate &a,
+                                              const hull::Coordinate &b,
+                                              const hull::Coordinate &c) const {
+  // closest point by Voronoi regions, see Ericson, Real-Time Collision
+  // Detection, 5.1.5
+  const auto A = toCloudFrame(a);
+  const auto B = toCloudFrame(b);
+  const auto C = toCloudFrame(c);
+  const auto P = getVector(index);
+  const auto AB = delta(B, A);
+  const auto AC = delta(C, A);
+  auto distance_to = [&P](const Vector3<Scalar> &closest) {
+    const auto gap = delta(P, closest);
+    return std::sqrt(dot(gap, gap));
+  };
+  auto along = [](const Vector3<Scalar> &origin, const Vector3<Scalar> &dir,
+                  Scalar t) {
+    return Vector3<Scalar>{origin.x + t * dir.x, origin.y + t * dir.y,
+                           origin.z + t * dir.z};
+  };
+
+  const auto AP = delta(P, A);
+  const Scalar d1 = dot(AB, AP), d2 = dot(AC, AP);
+  if ((d1 <= 0) && (d2 <= 0)) {
+    return distance_to(A);
+  }
+  const auto BP = delta(P, B);
+  const Scalar d3 = dot(AB, BP), d4 = dot(AC, BP);
+  if ((0 <= d3) && (d4 <= d3)) {
+    return distance_to(B);
+  }
+  const Scalar vc = d1 * d4 - d3 * d2;
+  if ((vc <= 0) && (0 <= d1) && (d3 <= 0)) {
+    return distance_to(along(A, AB, d1 / (d1 - d3)));
+  }
+  const auto CP = delta(P, C);
+  const Scalar d5 = dot(AB, CP), d6 = dot(AC, CP);
+  if ((0 <= d6) && (d5 <= d6)) {
+    return distance_to(C);
+  }
+  const Scalar vb = d5 * d2 - d1 * d6;
+  if ((vb <= 0) && (0 <= d2) && (d6 <= 0)) {
+    return distance_to(along(A, AC, d2 / (d2 - d6)));
+  }
+  const Scalar va = d3 * d6 - d5 * d4;
+  if ((va <= 0) && (0 <= (d4 - d3)) && (0 <= (d5 - d6))) {
+    return distance_to(
+        along(B, delta(C, B), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+  }
+  const Scalar denom = 1 / (va + vb + vc);
+  return distance_to(along(along(A, AB, vb * denom), AC, vc * denom));
+}
+
+template class PointCloud<float>;
+template class PointCloud<double>;
 } // namespace qh
@@ -1,36 +1,169 @@
 #pragma once
 
 #include <Hull/Coordinate.h>
+#include <QuickHull/FastQuickHull.h>
+
+#include "Kernels.h"
+#include "MortonOrder.h"
 
 #include <array>
+#include <cstdint>
 #include <optional>
-#include <unordered_map>
 #include <vector>
 
 namespace qh {
-class PointCloud {
+// Explicitly instantiated for float and double.
+// Mesh works with single precision coordinates: the ones passed to it are
+// expressed w.r.t. the center of the bounding box of the cloud, so that
+// the precision of the float representation is not wasted for far away
+// clouds.
+template <typename Scalar> class PointCloud {
 public:
-  PointCloud(const std::vector<hull::Coordinate> &points);
+  PointCloud() = default;
+  PointCloud(const BasicPointsView<Scalar> &points);
+
+  // The cloud is made a copy of points, reusing the already allocated
+  // buffers. When spatial_sort is true, the points are stored along a Morton
+  // curve, see getOriginalIndex.
+  void reset(const BasicPointsView<Scalar> &points,
+             bool spatial_sort = false);
+
+  // the points are added at the back of the cloud, as open vertices
+  void append(const BasicPointsView<Scalar> &points);
+
+  // the position in the passed points of the one stored at index
+  std::size_t getOriginalIndex(std::size_t index) const {
+    return permutation.empty() ? index : permutation[index];
+  }
+
+  // Computes the center and the tolerance from the bounding box of the
+  // current points, to call before building the hull. The points appended
+  // later keep using the same ones.
+  // When max_tolerance is given, the tolerance does not exceed it.
+  void fitBoundingBox(std::optional<Scalar> max_tolerance = std::nullopt);
+
+  Scalar getTolerance() const { return tolerance; }
+
+  // the greatest extent of the bounding box, computed by fitBoundingBox
+  Scalar getExtent() const { return extent; }
+
+  std::size_t size() const { return x.size(); }
+
+  // the point expressed w.r.t. the center, as it is passed to Mesh
+  hull::Coordinate getPoint(std::size_t index) const {
+    return hull::Coordinate{static_cast<float>(x[index] - center.x),
+                            static_cast<float>(y[index] - center.y),
+                            static_cast<float>(z[index] - center.z)};
+  }
+
+  // same as getPoint, without rounding the coordinates to single precision
+  Vector3<double> getPrecisePoint(std::size_t index) const {
+    return Vector3<double>{static_cast<double>(x[index] - center.x),
+                           static_cast<double>(y[index] - center.y),
+                           static_cast<double>(z[index] - center.z)};
+  }
+
+  Vector3<double> getCenter() const {
+    return Vector3<double>{static_cast<double>(center.x),
+                           static_cast<double>(center.y),
+                           static_cast<double>(center.z)};
+  }
+
+  // Closes the vertices surely inside the convex hull (see InteriorCulling).
+  // Returns the number of closed vertices.
+  std::size_t cullInteriorPoints(InteriorCulling directions, ThreadPool *pool,
+                                 std::size_t parallel_threshold);
+
+  // Closes all the vertices, except the farthest ones along the passed number
+  // of directions, evenly spread over the unit sphere (epsilon-kernel
+  // coreset). Returns the number of closed vertices.
+  std::size_t keepCoreset(std::size_t directions, ThreadPool *pool,
+                          std::size_t parallel_threshold);
+
+  // the plane passing by point and having the passed normal, both expressed
+  // as the facets of Mesh: its offset is w.r.t. the center
+  Plane<Scalar> getPlane(const hull::Coordinate &point,
+                         const hull::Coordinate &normal) const;
+
+  // Reopens all the vertices, except the ones strictly inside the polytope
+  // delimited by planes, as returned by getPlane, returning the open ones in
+  // ascending order
+  std::vector<std::size_t>
+  reopenOutside(const std::vector<Plane<Scalar>> &planes, ThreadPool *pool,
+                std::size_t parallel_threshold);
 
   std::array<std::size_t, 4> getInitialTethraedron() const;
 
   struct FarthestVertex {
     std::size_t vertex;
-    float distance;
+    Scalar distance;
   };
+  // only the vertices in outside_set, all in front of the facet according to
+  // isInFront, are considered: the result is empty only when outside_set is.
+  // point_on_facet is expressed w.r.t. the center, as returned by getPoint.
   std::optional<FarthestVertex>
   getFarthest(const hull::Coordinate &point_on_facet,
-              const hull::Coordinate &facet_normal) const;
+              const hull::Coordinate &facet_normal,
+              const std::vector<std::size_t> &outside_set) const;
 
-  void closeVertex(std::size_t index) {
-    const auto *to_close = &points[index];
-    open_set.erase(to_close);
-  };
+  bool isInFront(const hull::Coordinate &point_on_facet,
+                 const hull::Coordinate &facet_normal,
+                 std::size_t index) const;
+
+  // distance of the vertex from the triangle a, b, c, expressed w.r.t. the
+  // center, as returned by getPoint
+  Scalar distanceToTriangle(std::size_t index, const hull::Coordinate &a,
+                            const hull::Coordinate &b,
+                            const hull::Coordinate &c) const;
+
+  void closeVertex(std::size_t index) { open_set[index] = 0; };
 
-  const std::vector<hull::Coordinate> &points;
+  bool isOpen(std::size_t index) const { return open_set[index] != 0; }
+
+  CoordinatesSoA<Scalar> coordinates() const {
+    return CoordinatesSoA<Scalar>{x.data(), y.data(), z.data()};
+  }
 
 private:
-  // <vertex , index in points>
-  std::unordered_map<const hull::Coordinate *, std::size_t> open_set;
+  Vector3<Scalar> toCloudFrame(const hull::Coordinate &point) const {
+    return Vector3<Scalar>{static_cast<Scalar>(point.x) + center.x,
+                           static_cast<Scalar>(point.y) + center.y,
+                           static_cast<Scalar>(point.z) + center.z};
+  }
+
+  Vector3<Scalar> getVector(std::size_t index) const {
+    return Vector3<Scalar>{x[index], y[index], z[index]};
+  }
+
+  // copy of the points, stored as structure of arrays to enable the simd
+  // kernels
+  std::vector<Scalar> x;
+  std::vector<Scalar> y;
+  std::vector<Scalar> z;
+
+  Vector3<Scalar> center{0, 0, 0};
+  Scalar tolerance = 0;
+  Scalar extent = 0;
+
+  // flag for each element in points, telling whether it can still be added to
+  // the hull. Bytes rather than bits, as different threads may close
+  // different vertices at the same time.
+  std::vector<std::uint8_t> open_set;
+
+  MortonOrder<Scalar> morton_order;
+  // the original position of each point, empty when they were not sorted
+  std::vector<std::size_t> permutation;
+
+  // the extreme points found by the last cullInteriorPoints or keepCoreset,
+  // in ascending order
+  std::vector<std::size_t> extremes;
+
+  void findExtremes(const std::vector<Vector3<Scalar>> &directions,
+                    ThreadPool *pool, std::size_t parallel_threshold);
+
+  // closes the vertices strictly inside the polytope delimited by planes,
+  // whose offsets are expressed w.r.t. the center, returning their number
+  std::size_t closeInside(const std::vector<Plane<Scalar>> &planes,
+                          ThreadPool *pool, std::size_t parallel_threshold);
 };
 } // namespace qh
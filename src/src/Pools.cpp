@@ -0,0 +1,32 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include "Pools.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace qh {
+ThreadPool *get_pool(const ConvexHullContext &cntx) {
+  if (cntx.thread_pool != nullptr) {
+    return cntx.thread_pool;
+  }
+  if ((cntx.thread_pool_size == std::nullopt) ||
+      (*cntx.thread_pool_size == 1)) {
+    return nullptr;
+  }
+  static std::mutex pools_mtx;
+  static std::unordered_map<std::size_t, std::unique_ptr<ThreadPool>> pools;
+  std::scoped_lock lock(pools_mtx);
+  auto &pool = pools[*cntx.thread_pool_size];
+  if (pool == nullptr) {
+    pool = std::make_unique<ThreadPool>(*cntx.thread_pool_size);
+  }
+  return pool.get();
+}
+} // namespace qh
@@ -0,0 +1,18 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+namespace qh {
+// The pool to use according to the context: ConvexHullContext::thread_pool if
+// specified, otherwise a pool of ConvexHullContext::thread_pool_size threads,
+// kept alive and reused by the following calls asking for the same size.
+// nullptr is returned for serial computations.
+ThreadPool *get_pool(const ConvexHullContext &cntx);
+} // namespace qh
@@ -0,0 +1,166 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include <QuickHull/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace qh {
+namespace {
+void pin_to_core(std::thread &subject, std::size_t core) {
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core, &cpuset);
+  pthread_setaffinity_np(subject.native_handle(), sizeof(cpu_set_t), &cpuset);
+#endif
+}
+
+// each thread will process this number of chunks on average: a little bit of
+// oversubscription helps balancing uneven chunks
+static constexpr std::size_t CHUNKS_PER_THREAD = 4;
+} // namespace
+
+struct ThreadPool::Impl {
+  std::vector<std::thread> workers;
+
+  std::mutex submit_mtx;
+
+  std::mutex mtx;
+  std::condition_variable wake;
+  std::condition_variable done;
+  bool life = true;
+  std::size_t generation = 0;
+  std::size_t busy_workers = 0;
+  std::exception_ptr exception;
+
+  const Task *task = nullptr;
+  std::size_t range = 0;
+  std::size_t chunk = 1;
+  std::atomic_size_t next = 0;
+
+  void work() {
+    try {
+      while (true) {
+        std::size_t begin = next.fetch_add(chunk, std::memory_order_relaxed);
+        if (range <= begin) {
+          break;
+        }
+        (*task)(begin, std::min(begin + chunk, range));
+      }
+    } catch (...) {
+      std::scoped_lock lock(mtx);
+      if (!exception) {
+        exception = std::current_exception();
+      }
+      // prevent the other threads from taking new chunks
+      next.store(range);
+    }
+  }
+
+  void workerLoop() {
+    std::size_t last_generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        wake.wait(lock, [&]() {
+          return (!life) || (generation != last_generation);
+        });
+        if (!life) {
+          return;
+        }
+        last_generation = generation;
+      }
+      work();
+      {
+        std::scoped_lock lock(mtx);
+        if (--busy_workers == 0) {
+          done.notify_one();
+        }
+      }
+    }
+  }
+};
+
+ThreadPool::ThreadPool(std::size_t size, bool pin_threads)
+    : impl(std::make_unique<Impl>()) {
+  const std::size_t cores =
+      std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  if (size == 0) {
+    size = cores;
+  }
+  impl->workers.reserve(size - 1);
+  for (std::size_t k = 1; k < size; ++k) {
+    auto &worker = impl->workers.emplace_back(
+        [impl = impl.get()]() { impl->workerLoop(); });
+    if (pin_threads) {
+      pin_to_core(worker, k % cores);
+    }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock lock(impl->mtx);
+    impl->life = false;
+  }
+  impl->wake.notify_all();
+  for (auto &worker : impl->workers) {
+    worker.join();
+  }
+}
+
+std::size_t ThreadPool::size() const { return impl->workers.size() + 1; }
+
+void ThreadPool::parallelFor(std::size_t range, const Task &task,
+                             std::size_t chunk_size) {
+  if (range == 0) {
+    return;
+  }
+  if (impl->workers.empty()) {
+    task(0, range);
+    return;
+  }
+  std::scoped_lock submit_lock(impl->submit_mtx);
+  {
+    std::scoped_lock lock(impl->mtx);
+    impl->task = &task;
+    impl->range = range;
+    impl->chunk = (chunk_size == 0)
+                      ? std::max<std::size_t>(
+                            1, range / (size() * CHUNKS_PER_THREAD))
+                      : chunk_size;
+    impl->next.store(0);
+    impl->busy_workers = impl->workers.size();
+    impl->exception = nullptr;
+    ++impl->generation;
+  }
+  impl->wake.notify_all();
+  impl->work();
+  std::exception_ptr exception;
+  {
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    impl->done.wait(lock, [this]() { return impl->busy_workers == 0; });
+    impl->task = nullptr;
+    exception = impl->exception;
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+} // namespace qh
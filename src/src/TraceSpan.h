@@ -0,0 +1,45 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/Tracer.h>
+
+namespace qh {
+// Records into tracer the span going from construction to destruction. Does
+// nothing, without even reading the clock, when tracer is nullptr.
+class TraceSpan {
+public:
+  TraceSpan(Tracer *tracer, const char *name) : tracer(tracer), name(name) {
+    if (tracer != nullptr) {
+      begin = Tracer::Clock::now();
+    }
+  }
+
+  ~TraceSpan() {
+    if (tracer != nullptr) {
+      tracer->record(name, begin, Tracer::Clock::now(), arg_name, arg_value);
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+  // name should be a string literal
+  void setArg(const char *name, std::size_t value) {
+    arg_name = name;
+    arg_value = value;
+  }
+
+private:
+  Tracer *tracer;
+  const char *name;
+  Tracer::Clock::time_point begin;
+  const char *arg_name = nullptr;
+  std::size_t arg_value = 0;
+};
+} // namespace qh
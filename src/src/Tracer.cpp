@@ -0,0 +1,175 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include <QuickHull/Error.h>
+#include <QuickHull/Tracer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace qh {
+namespace {
+struct Span {
+  const char *name;
+  const char *arg_name;
+  std::size_t arg_value;
+  Tracer::Clock::time_point begin;
+  Tracer::Clock::time_point end;
+};
+
+// written only by the owning thread
+struct RingBuffer {
+  RingBuffer(std::size_t capacity, std::size_t thread)
+      : spans(capacity), thread(thread) {}
+
+  std::vector<Span> spans;
+  // total number of spans recorded: the last ones are at
+  // [written - spans.size(), written) modulo spans.size()
+  std::atomic_size_t written = 0;
+  std::size_t thread;
+};
+
+std::atomic<std::uint64_t> tracers_counter = 0;
+
+// the buffer used by the calling thread for the last tracer it recorded into
+struct ThreadCache {
+  std::uint64_t tracer = 0;
+  RingBuffer *buffer = nullptr;
+};
+thread_local ThreadCache thread_cache;
+} // namespace
+
+struct Tracer::Impl {
+  Impl(std::size_t capacity)
+      : id(++tracers_counter), capacity(std::max<std::size_t>(1, capacity)) {}
+
+  // unique among all the tracers ever created, unlike their addresses
+  const std::uint64_t id;
+  const std::size_t capacity;
+  Clock::time_point epoch = Clock::now();
+
+  mutable std::mutex buffers_mtx;
+  std::unordered_map<std::thread::id, std::unique_ptr<RingBuffer>> buffers;
+
+  RingBuffer &getBuffer() {
+    if (thread_cache.tracer == id) {
+      return *thread_cache.buffer;
+    }
+    // first span recorded by this thread
+    std::scoped_lock lock(buffers_mtx);
+    auto &buffer = buffers[std::this_thread::get_id()];
+    if (buffer == nullptr) {
+      buffer = std::make_unique<RingBuffer>(capacity, buffers.size() - 1);
+    }
+    thread_cache = ThreadCache{id, buffer.get()};
+    return *buffer;
+  }
+};
+
+Tracer::Tracer(std::size_t capacity)
+    : impl(std::make_unique<Impl>(capacity)) {}
+
+Tracer::~Tracer() = default;
+
+void Tracer::record(const char *name, Clock::time_point begin,
+                    Clock::time_point end, const char *arg_name,
+                    std::size_t arg_value) {
+  auto &buffer = impl->getBuffer();
+  const std::size_t written = buffer.written.load(std::memory_order_relaxed);
+  buffer.spans[written % buffer.spans.size()] =
+      Span{name, arg_name, arg_value, begin, end};
+  buffer.written.store(written + 1, std::memory_order_release);
+}
+
+std::size_t Tracer::size() const {
+  std::scoped_lock lock(impl->buffers_mtx);
+  std::size_t result = 0;
+  for (const auto &[thread, buffer] : impl->buffers) {
+    result += std::min(buffer->written.load(std::memory_order_acquire),
+                       buffer->spans.size());
+  }
+  return result;
+}
+
+void Tracer::clear() {
+  std::scoped_lock lock(impl->buffers_mtx);
+  for (auto &[thread, buffer] : impl->buffers) {
+    buffer->written.store(0);
+  }
+  impl->epoch = Clock::now();
+}
+
+namespace {
+// microseconds, as expected by the trace event format
+double to_micros(Tracer::Clock::duration duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+} // namespace
+
+void Tracer::dump(std::ostream &recipient) const {
+  std::scoped_lock lock(impl->buffers_mtx);
+  std::vector<const RingBuffer *> buffers;
+  for (const auto &[thread, buffer] : impl->buffers) {
+    buffers.push_back(buffer.get());
+  }
+  std::sort(buffers.begin(), buffers.end(),
+            [](const RingBuffer *a, const RingBuffer *b) {
+              return a->thread < b->thread;
+            });
+
+  const auto flags = recipient.flags();
+  const auto precision = recipient.precision();
+  // nanoseconds resolution
+  recipient << std::fixed << std::setprecision(3);
+  recipient << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  auto separate = [&]() {
+    recipient << (first ? "\n" : ",\n");
+    first = false;
+  };
+  for (const auto *buffer : buffers) {
+    separate();
+    recipient << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+              << buffer->thread << ",\"args\":{\"name\":\"thread "
+              << buffer->thread << "\"}}";
+    const std::size_t written = buffer->written.load(std::memory_order_acquire);
+    const std::size_t capacity = buffer->spans.size();
+    for (std::size_t k = (capacity < written) ? written - capacity : 0;
+         k < written; ++k) {
+      const auto &span = buffer->spans[k % capacity];
+      separate();
+      recipient << "{\"name\":\"" << span.name
+                << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread
+                << ",\"ts\":" << to_micros(span.begin - impl->epoch)
+                << ",\"dur\":" << to_micros(span.end - span.begin);
+      if (span.arg_name != nullptr) {
+        recipient << ",\"args\":{\"" << span.arg_name
+                  << "\":" << span.arg_value << '}';
+      }
+      recipient << '}';
+    }
+  }
+  recipient << "\n]}\n";
+  recipient.flags(flags);
+  recipient.precision(precision);
+}
+
+void Tracer::dump(const std::string &fileName) const {
+  std::ofstream stream(fileName);
+  if (!stream.is_open()) {
+    throw Error{fileName + " is an invalid filename"};
+  }
+  dump(stream);
+}
+} // namespace qh
@@ -1,8 +1,24 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
+#include <QuickHull/Async.h>
+#include <QuickHull/Batch.h>
+#include <QuickHull/Error.h>
+#include <QuickHull/HullEngine.h>
+#include <QuickHull/HullQuery.h>
+#include <QuickHull/IncrementalHull.h>
+#include <QuickHull/Tracer.h>
+#include <HullFiles.h>
 #include <Utils.h>
 
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <set>
+#include <sstream>
+
 TEST_CASE("Random clouds") {
   auto cloud = sampleCloud(2000);
   auto samples = GENERATE(10, 50, 100, 200, 500, 1000, 2000);
@@ -18,6 +34,887 @@ TEST_CASE("Random clouds") {
   }
 }
 
+namespace {
+bool is_convex(const std::vector<qh::FacetIncidences> &incidences,
+               const std::vector<hull::Coordinate> &normals,
+               const std::vector<Vector3d> &cloud) {
+  for (std::size_t f = 0; f < incidences.size(); ++f) {
+    auto facet_point = to_hull_coordinate(cloud[incidences[f][0]]);
+    for (const auto &vertex : cloud) {
+      hull::Coordinate delta;
+      hull::diff(delta, to_hull_coordinate(vertex), facet_point);
+      if (hull::dot(delta, normals[f]) > 1e-2f) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+} // namespace
+
+TEST_CASE("Convexity of the result") {
+  auto cloud = sampleCloud(20000);
+  auto threads = GENERATE(std::optional<std::size_t>{},
+                          std::make_optional<std::size_t>(2));
+
+  std::vector<hull::Coordinate> normals;
+  auto incidences =
+      qh::convex_hull(cloud.begin(), cloud.end(), to_hull_coordinate, normals,
+                      qh::ConvexHullContext{20000, threads});
+  CHECK(is_convex(incidences, normals, cloud));
+}
+
+TEST_CASE("Closed surface") {
+  auto cloud = sampleCloud(GENERATE(100, 20000));
+  // points on a sphere are all vertices of the hull
+  for (auto &point : cloud) {
+    const float norm = std::sqrt(point.x() * point.x() + point.y() * point.y() +
+                                 point.z() * point.z());
+    point = Vector3d{point.x() / norm, point.y() / norm, point.z() / norm};
+  }
+
+  auto incidences =
+      qh::convex_hull(cloud.begin(), cloud.end(), to_hull_coordinate,
+                      qh::ConvexHullContext{20000, std::nullopt});
+  // each edge is shared by 2 facets, traversing it in opposite directions
+  std::set<std::pair<std::size_t, std::size_t>> edges;
+  for (const auto &facet : incidences) {
+    for (std::size_t k = 0; k < 3; ++k) {
+      CHECK(edges.emplace(facet[k], facet[(k + 1) % 3]).second);
+    }
+  }
+  for (const auto &[from, to] : edges) {
+    CHECK(edges.find(std::make_pair(to, from)) != edges.end());
+  }
+}
+
+TEST_CASE("Shared thread pool") {
+  qh::ThreadPool pool(3);
+  CHECK(pool.size() == 3);
+
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.thread_pool = &pool;
+  context.parallel_threshold = GENERATE(0, 1024);
+
+  for (std::size_t trial = 0; trial < 5; ++trial) {
+    auto cloud = sampleCloud(5000);
+    std::vector<hull::Coordinate> normals;
+    auto incidences = qh::convex_hull(cloud.begin(), cloud.end(),
+                                      to_hull_coordinate, normals, context);
+    CHECK(is_convex(incidences, normals, cloud));
+  }
+}
+
+TEST_CASE("Reusable engine") {
+  qh::HullEngine engine(qh::ConvexHullContext{20000, std::nullopt});
+
+  for (const std::size_t size : {1000, 50, 3000, 3000, 10}) {
+    auto cloud = sampleCloud(size);
+    std::vector<hull::Coordinate> points;
+    std::for_each(cloud.begin(), cloud.end(), [&points](const Vector3d &v) {
+      points.push_back(to_hull_coordinate(v));
+    });
+
+    const auto &incidences = engine.compute(points);
+    CHECK(is_convex(incidences, engine.getNormals(), cloud));
+    CHECK(incidences == qh::convex_hull(points, engine.getContext()));
+  }
+}
+
+TEST_CASE("Batch of clouds") {
+  std::vector<std::vector<Vector3d>> clouds;
+  std::vector<std::vector<hull::Coordinate>> points;
+  for (std::size_t k = 0; k < 50; ++k) {
+    auto &cloud = clouds.emplace_back(sampleCloud(20 + 40 * k));
+    auto &cloud_points = points.emplace_back();
+    std::for_each(cloud.begin(), cloud.end(),
+                  [&cloud_points](const Vector3d &v) {
+                    cloud_points.push_back(to_hull_coordinate(v));
+                  });
+  }
+
+  qh::ConvexHullContext context;
+  context.thread_pool_size = GENERATE(std::optional<std::size_t>{},
+                                      std::make_optional<std::size_t>(3));
+  qh::BatchResult result;
+  // the second batch reuses the buffers of the first one
+  for (std::size_t trial = 0; trial < 2; ++trial) {
+    qh::convex_hull_batch(points, result, context);
+    REQUIRE(result.size() == clouds.size());
+    for (std::size_t k = 0; k < clouds.size(); ++k) {
+      std::vector<qh::FacetIncidences> incidences(
+          result.incidences.begin() + result.offsets[k],
+          result.incidences.begin() + result.offsets[k + 1]);
+      std::vector<hull::Coordinate> normals(
+          result.normals.begin() + result.offsets[k],
+          result.normals.begin() + result.offsets[k + 1]);
+      CHECK(is_convex(incidences, normals, clouds[k]));
+      CHECK(incidences == qh::convex_hull(points[k], context));
+      CHECK_FALSE(result.failed(k));
+    }
+  }
+
+  SECTION("Clouds whose hull can't be computed") {
+    // too few points, and points on a plane
+    points[10].resize(3);
+    for (auto &point : points[20]) {
+      point.z = 0;
+    }
+    result.compute_mass_properties = true;
+    qh::convex_hull_batch(points, result, context);
+    REQUIRE(result.size() == clouds.size());
+    for (std::size_t k = 0; k < clouds.size(); ++k) {
+      const bool failed = (k == 10) || (k == 20);
+      CHECK(result.failed(k) == failed);
+      CHECK((result.offsets[k] == result.offsets[k + 1]) == failed);
+      if (failed) {
+        CHECK(result.mass_properties[k].volume == 0);
+      } else {
+        CHECK(0 < result.mass_properties[k].volume);
+      }
+    }
+  }
+}
+
+TEST_CASE("Interior points culling") {
+  auto cloud = sampleCloud(20000);
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.interior_culling =
+      GENERATE(qh::InteriorCulling::DOP_6, qh::InteriorCulling::DOP_14,
+               qh::InteriorCulling::DOP_26);
+  context.thread_pool_size = GENERATE(std::optional<std::size_t>{},
+                                      std::make_optional<std::size_t>(2));
+  context.parallel_threshold = 0;
+
+  std::vector<hull::Coordinate> normals;
+  auto incidences = qh::convex_hull(cloud.begin(), cloud.end(),
+                                    to_hull_coordinate, normals, context);
+  CHECK(is_convex(incidences, normals, cloud));
+}
+
+TEST_CASE("Divide and conquer") {
+  auto cloud = sampleCloud(20000);
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.thread_pool_size = GENERATE(2, 3);
+  context.parallel_threshold = 0;
+  context.parallel_mode = qh::ParallelMode::DIVIDE_AND_CONQUER;
+  context.interior_culling =
+      GENERATE(qh::InteriorCulling::NONE, qh::InteriorCulling::DOP_14);
+
+  std::vector<hull::Coordinate> normals;
+  auto incidences = qh::convex_hull(cloud.begin(), cloud.end(),
+                                    to_hull_coordinate, normals, context);
+  CHECK(is_convex(incidences, normals, cloud));
+
+  SECTION("Too few points") {
+    cloud.erase(cloud.begin() + GENERATE(0, 3), cloud.end());
+    CHECK_THROWS_AS(qh::convex_hull(cloud.begin(), cloud.end(),
+                                    to_hull_coordinate, context),
+                    qh::Error);
+  }
+
+  SECTION("Invalid stride") {
+    std::vector<float> buffer(30, 0);
+    CHECK_THROWS_AS(
+        qh::convex_hull(qh::PointsView{buffer.data(), 10, 2}, context),
+        qh::Error);
+  }
+}
+
+TEST_CASE("Divide and conquer on a sphere") {
+  // all the points are vertices, also when the sphere is squashed into a
+  // thin disk, making the chunks thin slabs
+  const float flattening = GENERATE(1.f, 0.02f);
+  std::mt19937 engine(0);
+  std::normal_distribution<float> distribution;
+  std::vector<hull::Coordinate> points;
+  for (std::size_t k = 0; k < 100; ++k) {
+    hull::Coordinate direction{distribution(engine), distribution(engine),
+                               distribution(engine)};
+    const float scale = 100.f / std::sqrt(hull::dot(direction, direction));
+    points.push_back(hull::Coordinate{scale * direction.x,
+                                      scale * direction.y,
+                                      flattening * scale * direction.z});
+  }
+  auto vertices = [](const std::vector<qh::FacetIncidences> &incidences) {
+    std::set<std::size_t> result;
+    for (const auto &facet : incidences) {
+      result.insert(facet.begin(), facet.end());
+    }
+    return result;
+  };
+
+  qh::ConvexHullContext context;
+  const auto expected = vertices(qh::convex_hull(points, context));
+  CHECK(expected.size() == points.size());
+
+  context.thread_pool_size = 2;
+  context.parallel_threshold = 0;
+  context.parallel_mode = qh::ParallelMode::DIVIDE_AND_CONQUER;
+  context.spatial_sort = GENERATE(false, true);
+  CHECK(vertices(qh::convex_hull(points, context)) == expected);
+}
+
+TEST_CASE("Spatial sort") {
+  auto cloud = sampleCloud(GENERATE(100, 20000));
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.thread_pool_size = GENERATE(std::optional<std::size_t>{},
+                                      std::make_optional<std::size_t>(2));
+  context.parallel_threshold = 0;
+  context.parallel_mode = GENERATE(qh::ParallelMode::PER_ITERATION,
+                                   qh::ParallelMode::DIVIDE_AND_CONQUER);
+  context.spatial_sort = true;
+
+  std::vector<hull::Coordinate> normals;
+  const auto incidences = qh::convex_hull(
+      cloud.begin(), cloud.end(), to_hull_coordinate, normals, context);
+  CHECK(is_convex(incidences, normals, cloud));
+  // the incidences refer to the original positions: the vertices of each
+  // facet lie on its plane, in counter clockwise order around its normal
+  for (std::size_t f = 0; f < incidences.size(); ++f) {
+    const auto A = to_hull_coordinate(cloud[incidences[f][0]]);
+    hull::Coordinate AB, AC, normal;
+    hull::diff(AB, to_hull_coordinate(cloud[incidences[f][1]]), A);
+    hull::diff(AC, to_hull_coordinate(cloud[incidences[f][2]]), A);
+    CHECK(std::abs(hull::dot(AB, normals[f])) < 1e-3f);
+    CHECK(std::abs(hull::dot(AC, normals[f])) < 1e-3f);
+    hull::cross(normal, AB, AC);
+    CHECK(0 < hull::dot(normal, normals[f]));
+  }
+}
+
+TEST_CASE("Batch insertion") {
+  auto cloud = sampleCloud(20000);
+  qh::ConvexHullStats stats;
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.thread_pool_size = GENERATE(std::optional<std::size_t>{},
+                                      std::make_optional<std::size_t>(2));
+  context.parallel_threshold = 0;
+  context.batch_size = GENERATE(4, 64);
+  context.stats = &stats;
+
+  std::vector<hull::Coordinate> normals;
+  const auto incidences = qh::convex_hull(
+      cloud.begin(), cloud.end(), to_hull_coordinate, normals, context);
+  CHECK(is_convex(incidences, normals, cloud));
+  CHECK_FALSE(stats.max_iterations_reached);
+  CHECK(stats.batches < stats.iterations);
+  CHECK(stats.facets_added - stats.facets_removed == incidences.size());
+  std::set<std::pair<std::size_t, std::size_t>> edges;
+  for (const auto &facet : incidences) {
+    for (std::size_t k = 0; k < 3; ++k) {
+      CHECK(edges.emplace(facet[k], facet[(k + 1) % 3]).second);
+    }
+  }
+  for (const auto &[from, to] : edges) {
+    CHECK(edges.find(std::make_pair(to, from)) != edges.end());
+  }
+
+  // no more vertices than max_iterations are added, batches included
+  context.max_iterations = 10;
+  qh::convex_hull(cloud.begin(), cloud.end(), to_hull_coordinate, context);
+  CHECK(stats.iterations == 11);
+  CHECK(stats.max_iterations_reached);
+}
+
+TEST_CASE("Run statistics") {
+  auto cloud = sampleCloud(5000);
+  std::vector<hull::Coordinate> points;
+  std::for_each(cloud.begin(), cloud.end(), [&points](const Vector3d &v) {
+    points.push_back(to_hull_coordinate(v));
+  });
+
+  qh::ConvexHullStats stats;
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.stats = &stats;
+  context.thread_pool_size = GENERATE(std::optional<std::size_t>{},
+                                      std::make_optional<std::size_t>(2));
+  context.parallel_threshold = 0;
+
+  auto incidences = qh::convex_hull(points, context);
+  std::vector<std::size_t> vertices;
+  for (const auto &facet : incidences) {
+    vertices.insert(vertices.end(), facet.begin(), facet.end());
+  }
+  std::sort(vertices.begin(), vertices.end());
+  vertices.erase(std::unique(vertices.begin(), vertices.end()),
+                 vertices.end());
+
+  // a vertex may become part of the interior of a facet, within the tolerance
+  CHECK(vertices.size() <= stats.iterations + 4);
+  CHECK_FALSE(stats.max_iterations_reached);
+  CHECK(stats.facets_added - stats.facets_removed == incidences.size());
+  CHECK(points.size() <= stats.distance_evaluations);
+  CHECK(0 < stats.peak_open_set_size);
+  CHECK(stats.peak_open_set_size < points.size());
+  CHECK(0 < stats.hull_update_time.count());
+  CHECK(0 < stats.distances_update_time.count());
+  CHECK(0 < stats.setup_time.count());
+
+  // the stats are overwritten by the next computation
+  context.max_iterations = 10;
+  qh::convex_hull(points, context);
+  CHECK(stats.iterations == 11);
+  CHECK(stats.max_iterations_reached);
+}
+
+namespace {
+bool are_close(double a, double b, double tolerance = 1e-6) {
+  return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+}
+
+bool are_close(const qh::MassProperties &a, const qh::MassProperties &b,
+               double tolerance = 1e-6) {
+  bool result = are_close(a.volume, b.volume, tolerance) &&
+                are_close(a.surface_area, b.surface_area, tolerance);
+  for (std::size_t i = 0; i < 3; ++i) {
+    result = result && are_close(a.centroid[i], b.centroid[i], tolerance);
+    for (std::size_t j = 0; j < 3; ++j) {
+      result = result && are_close(a.inertia[i][j], b.inertia[i][j], tolerance);
+    }
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("Mass properties") {
+  qh::MassProperties mass_properties;
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.mass_properties = &mass_properties;
+
+  SECTION("Box") {
+    // the corners of a 2 x 4 x 6 box far from the origin, together with
+    // points inside and on its faces
+    const hull::Coordinate center{100.f, -50.f, 20.f};
+    const float sides[3] = {2.f, 4.f, 6.f};
+    std::vector<hull::Coordinate> points;
+    for (const auto &v : sampleCloud(2000)) {
+      points.push_back(hull::Coordinate{center.x + v.x() * sides[0] / 2,
+                                        center.y + v.y() * sides[1] / 2,
+                                        center.z + v.z() * sides[2] / 2});
+    }
+    for (std::size_t corner = 0; corner < 8; ++corner) {
+      auto coordinate = [&](std::size_t axis) {
+        return (((corner >> axis) & 1) ? 0.5f : -0.5f) * sides[axis];
+      };
+      points.push_back(hull::Coordinate{center.x + coordinate(0),
+                                        center.y + coordinate(1),
+                                        center.z + coordinate(2)});
+    }
+    points.push_back(
+        hull::Coordinate{center.x, center.y, center.z + sides[2] / 2});
+
+    qh::convex_hull(points, context);
+    const double mass = 2.0 * 4.0 * 6.0;
+    CHECK(are_close(mass_properties.volume, mass, 1e-5));
+    CHECK(are_close(mass_properties.surface_area, 2 * (8.0 + 12.0 + 24.0),
+                    1e-5));
+    CHECK(are_close(mass_properties.centroid[0], center.x, 1e-5));
+    CHECK(are_close(mass_properties.centroid[1], center.y, 1e-5));
+    CHECK(are_close(mass_properties.centroid[2], center.z, 1e-5));
+    auto squared = [&](std::size_t axis) {
+      return static_cast<double>(sides[axis] * sides[axis]);
+    };
+    CHECK(are_close(mass_properties.inertia[0][0],
+                    mass * (squared(1) + squared(2)) / 12, 1e-5));
+    CHECK(are_close(mass_properties.inertia[1][1],
+                    mass * (squared(0) + squared(2)) / 12, 1e-5));
+    CHECK(are_close(mass_properties.inertia[2][2],
+                    mass * (squared(0) + squared(1)) / 12, 1e-5));
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 3; ++j) {
+        if (i != j) {
+          CHECK(std::abs(mass_properties.inertia[i][j]) < 1e-4);
+        }
+      }
+    }
+  }
+
+  SECTION("Same properties from every entry point") {
+    auto cloud = sampleCloud(3000);
+    std::vector<hull::Coordinate> points;
+    std::for_each(cloud.begin(), cloud.end(), [&points](const Vector3d &v) {
+      points.push_back(to_hull_coordinate(v));
+    });
+    auto incidences = qh::convex_hull(points, context);
+    const auto expected = mass_properties;
+
+    // volume and area computed summing the tethraedra and the triangles
+    double volume = 0, area = 0;
+    for (const auto &facet : incidences) {
+      const auto &a = points[facet[0]];
+      hull::Coordinate ab, ac, normal;
+      hull::diff(ab, points[facet[1]], a);
+      hull::diff(ac, points[facet[2]], a);
+      hull::cross(normal, ab, ac);
+      area += std::sqrt(hull::dot(normal, normal)) / 2;
+      volume += hull::dot(normal, a) / 6;
+    }
+    CHECK(are_close(expected.volume, volume, 1e-4));
+    CHECK(are_close(expected.surface_area, area, 1e-4));
+
+    // the other entry points may keep or discard some vertices closer than
+    // the tolerance to the hull
+    const double tolerance = 1e-3;
+
+    std::vector<double> points_d;
+    for (const auto &point : points) {
+      points_d.insert(points_d.end(), {point.x, point.y, point.z});
+    }
+    qh::convex_hull(qh::PointsViewD{points_d.data(), points.size()},
+                    context);
+    CHECK(are_close(mass_properties, expected, tolerance));
+
+    qh::ConvexHullContext parallel_context = context;
+    parallel_context.thread_pool_size = 2;
+    parallel_context.parallel_threshold = 0;
+    parallel_context.parallel_mode =
+        GENERATE(qh::ParallelMode::PER_ITERATION,
+                 qh::ParallelMode::DIVIDE_AND_CONQUER);
+    mass_properties = qh::MassProperties{};
+    qh::convex_hull(points, parallel_context);
+    CHECK(are_close(mass_properties, expected, tolerance));
+
+    qh::IncrementalHull incremental(context);
+    incremental.insert(qh::PointsView{&points.front().x, 1000});
+    incremental.insert(
+        qh::PointsView{&points[1000].x, points.size() - 1000});
+    CHECK(are_close(mass_properties, expected, tolerance));
+
+    qh::BatchResult batch;
+    batch.compute_mass_properties = true;
+    std::vector<std::vector<hull::Coordinate>> clouds = {points, points};
+    clouds.back().resize(50);
+    qh::convex_hull_batch(clouds, batch, context);
+    REQUIRE(batch.mass_properties.size() == 2);
+    CHECK(are_close(batch.mass_properties.front(), expected));
+    qh::convex_hull(clouds.back(), context);
+    CHECK(are_close(batch.mass_properties.back(), mass_properties));
+  }
+}
+
+namespace {
+// the largest distance of a point of the cloud in front of some facet: a
+// lower bound of the Hausdorff distance between the cloud and the hull
+float distance_outside(const std::vector<qh::FacetIncidences> &incidences,
+                       const std::vector<hull::Coordinate> &normals,
+                       const std::vector<hull::Coordinate> &points) {
+  float result = 0;
+  for (const auto &point : points) {
+    float distance = std::numeric_limits<float>::max();
+    for (std::size_t f = 0; f < incidences.size(); ++f) {
+      hull::Coordinate delta;
+      hull::diff(delta, point, points[incidences[f][0]]);
+      distance = std::min(distance, -hull::dot(delta, normals[f]));
+    }
+    result = std::max(result, -distance);
+  }
+  return result;
+}
+
+std::size_t count_vertices(const std::vector<qh::FacetIncidences> &incidences) {
+  std::set<std::size_t> vertices;
+  for (const auto &facet : incidences) {
+    vertices.insert(facet.begin(), facet.end());
+  }
+  return vertices.size();
+}
+} // namespace
+
+TEST_CASE("Approximate hull") {
+  auto cloud = sampleCloud(20000);
+  std::vector<hull::Coordinate> points;
+  std::for_each(cloud.begin(), cloud.end(), [&points](const Vector3d &v) {
+    points.push_back(to_hull_coordinate(v));
+  });
+
+  qh::ConvexHullStats stats;
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.stats = &stats;
+  context.thread_pool_size = GENERATE(std::optional<std::size_t>{},
+                                      std::make_optional<std::size_t>(2));
+  context.parallel_threshold = 0;
+
+  std::vector<hull::Coordinate> normals;
+  const auto exact = qh::convex_hull(points, normals, context);
+  CHECK(stats.approximation_error == 0);
+
+  qh::Approximation approximation;
+  SECTION("Tolerance") {
+    approximation.relative_tolerance = 0.05f;
+    context.approximation = approximation;
+    const auto incidences = qh::convex_hull(points, normals, context);
+    CHECK(incidences.size() < exact.size());
+    CHECK(stats.max_iterations_reached);
+    CHECK(0 < stats.approximation_error);
+    CHECK(distance_outside(incidences, normals, points) <=
+          stats.approximation_error + 1e-4);
+  }
+
+  SECTION("Vertices budget") {
+    approximation.relative_tolerance = 0;
+    approximation.max_vertices = 20;
+    context.approximation = approximation;
+    const auto incidences = qh::convex_hull(points, normals, context);
+    CHECK(count_vertices(incidences) <= 20);
+    CHECK(distance_outside(incidences, normals, points) <=
+          stats.approximation_error + 1e-4);
+  }
+
+  SECTION("Facets budget") {
+    approximation.relative_tolerance = 0;
+    approximation.max_facets = 31;
+    context.approximation = approximation;
+    const auto incidences = qh::convex_hull(points, normals, context);
+    CHECK(incidences.size() <= 31);
+    CHECK(distance_outside(incidences, normals, points) <=
+          stats.approximation_error + 1e-4);
+  }
+
+  SECTION("Coreset") {
+    approximation.relative_tolerance = 0;
+    approximation.coreset_directions = 64;
+    context.approximation = approximation;
+    const auto incidences = qh::convex_hull(points, normals, context);
+    CHECK(count_vertices(incidences) <= 64);
+    CHECK(stats.iterations <= 60);
+    CHECK(0 < stats.approximation_error);
+    CHECK(distance_outside(incidences, normals, points) <=
+          stats.approximation_error + 1e-4);
+  }
+}
+
+TEST_CASE("Asynchronous computation") {
+  auto cloud = sampleCloud(5000);
+  std::vector<hull::Coordinate> points;
+  std::for_each(cloud.begin(), cloud.end(), [&points](const Vector3d &v) {
+    points.push_back(to_hull_coordinate(v));
+  });
+  qh::ConvexHullStats stats;
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.stats = &stats;
+
+  SECTION("Same result as the blocking version") {
+    auto result = qh::convex_hull_async(points, context).get();
+    CHECK_FALSE(stats.interrupted);
+    std::vector<hull::Coordinate> normals;
+    CHECK(result.incidences == qh::convex_hull(points, normals, context));
+    CHECK(result.normals.size() == normals.size());
+  }
+
+  SECTION("Progress") {
+    std::vector<qh::Progress> notified;
+    context.progress = [&notified](const qh::Progress &progress) {
+      notified.push_back(progress);
+    };
+    qh::convex_hull_async(qh::make_view(points), context).get();
+    REQUIRE(notified.size() == stats.batches);
+    for (std::size_t k = 1; k < notified.size(); ++k) {
+      CHECK(notified[k - 1].iterations < notified[k].iterations);
+    }
+    CHECK(notified.back().iterations == stats.iterations);
+    CHECK(notified.back().distance == 0);
+  }
+
+  SECTION("Cancellation") {
+    qh::CancellationToken token;
+    context.cancellation = &token;
+    context.progress = [&token](const qh::Progress &progress) {
+      if (progress.iterations == 10) {
+        token.cancel();
+      }
+    };
+    auto result = qh::convex_hull_async(points, context).get();
+    CHECK(stats.interrupted);
+    CHECK(stats.iterations == 10);
+    // a closed surface, made of some of the vertices added so far
+    CHECK(result.incidences.size() <= 2 * (stats.iterations + 4) - 4);
+    CHECK(result.incidences.size() == result.normals.size());
+  }
+
+  SECTION("Deadline") {
+    context.thread_pool_size = 2;
+    // the chunk hulls ignore the deadline, only the final one is truncated
+    context.parallel_mode = GENERATE(qh::ParallelMode::PER_ITERATION,
+                                     qh::ParallelMode::DIVIDE_AND_CONQUER);
+    context.deadline = std::chrono::steady_clock::now();
+    auto result = qh::convex_hull_async(points, context).get();
+    // the initial tethraedron
+    CHECK(result.incidences.size() == 4);
+    CHECK(stats.interrupted);
+  }
+
+  SECTION("Errors") {
+    points.resize(3);
+    auto future = qh::convex_hull_async(points, context);
+    CHECK_THROWS_AS(future.get(), qh::Error);
+  }
+}
+
+TEST_CASE("Timeline tracing") {
+  auto cloud = sampleCloud(5000);
+  std::vector<hull::Coordinate> points;
+  std::for_each(cloud.begin(), cloud.end(), [&points](const Vector3d &v) {
+    points.push_back(to_hull_coordinate(v));
+  });
+
+  const std::size_t capacity = GENERATE(16, 1 << 16);
+  qh::Tracer tracer(capacity);
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.tracer = &tracer;
+  context.thread_pool_size = 2;
+  context.parallel_threshold = 0;
+
+  qh::convex_hull(points, context);
+  CHECK(0 < tracer.size());
+  // the pool threads and the calling one
+  CHECK(tracer.size() <= 3 * capacity);
+
+  std::stringstream trace;
+  tracer.dump(trace);
+  CHECK(trace.str().find("\"traceEvents\"") != std::string::npos);
+  if (capacity == 16) {
+    // the spans of the first iterations have been overwritten
+    CHECK(trace.str().find("\"setup\"") == std::string::npos);
+  } else {
+    for (const auto *phase : {"setup", "iteration", "best selection",
+                              "hull update", "distances update",
+                              "changed facets", "removed facets",
+                              "assign orphans", "farthest vertices"}) {
+      CHECK(trace.str().find(std::string{'"'} + phase + '"') !=
+            std::string::npos);
+    }
+  }
+
+  tracer.clear();
+  CHECK(tracer.size() == 0);
+}
+
+TEST_CASE("Incremental hull") {
+  qh::ConvexHullContext context;
+  context.max_iterations = 20000;
+  context.thread_pool_size = GENERATE(std::optional<std::size_t>{},
+                                      std::make_optional<std::size_t>(2));
+  context.parallel_threshold = 0;
+  qh::IncrementalHull subject(context);
+
+  std::vector<Vector3d> cloud;
+  auto insert = [&](const std::vector<Vector3d> &points) {
+    std::vector<hull::Coordinate> batch;
+    for (const auto &point : points) {
+      cloud.push_back(point);
+      batch.push_back(to_hull_coordinate(point));
+    }
+    subject.insert(batch);
+    CHECK(subject.size() == cloud.size());
+  };
+
+  // flat clouds: no hull yet
+  insert({Vector3d{0, 0, 0}, Vector3d{1, 0, 0}});
+  CHECK(subject.getIncidences().empty());
+  insert({Vector3d{0, 1, 0}, Vector3d{1, 1, 0}});
+  CHECK(subject.getIncidences().empty());
+
+  for (const std::size_t size : {10, 1000, 50, 3000}) {
+    insert(sampleCloud(size));
+    const auto &incidences = subject.getIncidences();
+    REQUIRE(incidences.size() == subject.getNormals().size());
+    CHECK(!incidences.empty());
+    CHECK(is_convex(incidences, subject.getNormals(), cloud));
+  }
+}
+
+TEST_CASE("Strided points view") {
+  auto cloud = sampleCloud(3000);
+  // interleaved position, normal and uv
+  std::vector<float> buffer;
+  for (const auto &vertex : cloud) {
+    buffer.insert(buffer.end(), {vertex.x(), vertex.y(), vertex.z(), 0.f, 0.f,
+                                 1.f, 0.5f, 0.5f});
+  }
+
+  std::vector<hull::Coordinate> normals;
+  auto incidences = qh::convex_hull(
+      qh::PointsView{buffer.data(), cloud.size(), 8}, normals);
+  CHECK(is_convex(incidences, normals, cloud));
+  CHECK(incidences ==
+        qh::convex_hull(cloud.begin(), cloud.end(), to_hull_coordinate));
+}
+
+TEST_CASE("Double precision") {
+  auto cloud = sampleCloud(5000);
+  // far away from the origin, the coordinates are not representable in single
+  // precision
+  const double offset = GENERATE(0.0, 1e7);
+  std::vector<double> buffer;
+  for (const auto &vertex : cloud) {
+    buffer.insert(buffer.end(), {offset + vertex.x(), offset + vertex.y(),
+                                 offset + vertex.z()});
+  }
+
+  qh::HullEngine engine(qh::ConvexHullContext{20000, std::nullopt});
+  const auto &incidences =
+      engine.compute(qh::PointsViewD{buffer.data(), cloud.size()});
+  CHECK(is_convex(incidences, engine.getNormals(), cloud));
+}
+
+TEST_CASE("Interior points culling far from the origin") {
+  auto cloud = sampleCloud(1000);
+  std::vector<double> buffer;
+  for (const auto &vertex : cloud) {
+    buffer.insert(buffer.end(), {1e4 + vertex.x(), -2e4 + vertex.y(),
+                                 3e4 + vertex.z()});
+  }
+  auto vertices = [&](qh::InteriorCulling culling) {
+    qh::ConvexHullContext context{1000, std::nullopt};
+    context.interior_culling = culling;
+    qh::HullEngine engine(context);
+    std::set<std::size_t> result;
+    for (const auto &facet :
+         engine.compute(qh::PointsViewD{buffer.data(), cloud.size()})) {
+      result.insert(facet.begin(), facet.end());
+    }
+    return result;
+  };
+  // the culled points are strictly inside the hull: no vertex is lost
+  CHECK(vertices(qh::InteriorCulling::DOP_26) ==
+        vertices(qh::InteriorCulling::NONE));
+}
+
+TEST_CASE("Thin slice of a big sphere") {
+  // all the points are vertices: the tolerance should not discard any of
+  // them, even if the cloud is far bigger along two axes
+  const std::vector<hull::Coordinate> points = {
+      {17.806541f, -23.108255f, 95.650063f},
+      {15.905283f, 12.385902f, -97.946983f},
+      {13.493622f, -93.495071f, -32.811481f},
+      {13.747546f, -95.629448f, 25.807262f},
+      {12.853664f, -26.966309f, 95.433762f},
+      {13.575771f, -94.496475f, -29.767668f},
+      {16.587744f, -91.492058f, -36.797421f},
+      {13.731030f, -83.171532f, -53.795486f},
+      {14.726755f, -85.807487f, -49.195507f},
+      {13.643083f, 17.542212f, -97.499428f},
+      {15.916986f, 36.822346f, 91.601120f},
+      {17.560043f, 10.787571f, -97.853325f}};
+
+  std::vector<hull::Coordinate> normals;
+  auto incidences = qh::convex_hull(points, normals);
+  CHECK(count_vertices(incidences) == points.size());
+  CHECK(distance_outside(incidences, normals, points) < 1e-3f);
+}
+
+TEST_CASE("Points close to the tolerance") {
+  // all the points are vertices, many of them almost coplanar with the
+  // facets built along the way: none should be left outside of the hull
+  const std::size_t size = GENERATE(500, 2000);
+  const float flattening = GENERATE(1.f, 0.05f);
+  std::mt19937 engine(static_cast<unsigned>(size));
+  std::normal_distribution<float> distribution;
+  std::vector<hull::Coordinate> points;
+  for (std::size_t k = 0; k < size; ++k) {
+    hull::Coordinate direction{distribution(engine), distribution(engine),
+                               distribution(engine)};
+    const float scale = 1.f / std::sqrt(hull::dot(direction, direction));
+    points.push_back(hull::Coordinate{scale * direction.x,
+                                      scale * direction.y,
+                                      flattening * scale * direction.z});
+  }
+
+  qh::ConvexHullContext context;
+  context.max_iterations = 2 * size;
+  SECTION("Serial") {}
+  SECTION("Divide and conquer") {
+    context.thread_pool_size = 4;
+    context.parallel_threshold = 0;
+    context.parallel_mode = qh::ParallelMode::DIVIDE_AND_CONQUER;
+    context.spatial_sort = GENERATE(false, true);
+  }
+  std::vector<hull::Coordinate> normals;
+  auto incidences = qh::convex_hull(points, normals, context);
+  CHECK(count_vertices(incidences) == size);
+  CHECK(distance_outside(incidences, normals, points) < 1e-4f);
+}
+
+TEST_CASE("Hull queries") {
+  auto cloud = sampleCloud(GENERATE(50, 5000));
+  std::vector<hull::Coordinate> points;
+  std::for_each(cloud.begin(), cloud.end(), [&points](const Vector3d &v) {
+    points.push_back(to_hull_coordinate(v));
+  });
+  std::vector<hull::Coordinate> normals;
+  const auto incidences =
+      qh::convex_hull(points, normals, qh::ConvexHullContext{20000});
+  const qh::HullQuery query(points, incidences, normals);
+  CHECK(query.facetsSize() == incidences.size());
+
+  const auto queries = sampleCloud(1000);
+
+  SECTION("Support") {
+    std::size_t hint = 0;
+    for (const auto &sample : queries) {
+      const auto direction = to_hull_coordinate(sample);
+      float expected = std::numeric_limits<float>::lowest();
+      for (const auto &facet : incidences) {
+        for (const auto vertex : facet) {
+          expected = std::max(expected, hull::dot(points[vertex], direction));
+        }
+      }
+      CHECK(hull::dot(points[query.support(direction)], direction) ==
+            expected);
+      hint = query.support(direction, hint);
+      CHECK(hull::dot(points[hint], direction) == expected);
+    }
+  }
+
+  SECTION("Containment") {
+    // half of the samples inside the hull, half outside
+    std::vector<hull::Coordinate> samples;
+    for (const auto &sample : queries) {
+      auto point = to_hull_coordinate(sample);
+      point.x *= 1.3f;
+      point.y *= 1.3f;
+      point.z *= 1.3f;
+      samples.push_back(point);
+    }
+    std::vector<std::uint8_t> batch;
+    query.contains(samples, batch);
+    REQUIRE(batch.size() == samples.size());
+    for (std::size_t k = 0; k < samples.size(); ++k) {
+      bool expected = true;
+      for (std::size_t f = 0; f < incidences.size(); ++f) {
+        hull::Coordinate delta;
+        hull::diff(delta, samples[k], points[incidences[f][0]]);
+        expected = expected && (hull::dot(delta, normals[f]) <=
+                                query.getTolerance());
+      }
+      CHECK(query.contains(samples[k]) == expected);
+      CHECK((batch[k] == 1) == expected);
+    }
+  }
+
+  SECTION("Invalid hull") {
+    CHECK_THROWS_AS(qh::HullQuery(points, incidences, {}), qh::Error);
+    auto open_surface = incidences;
+    open_surface.pop_back();
+    open_surface.pop_back();
+    CHECK_THROWS_AS(
+        qh::HullQuery(points, open_surface,
+                      std::vector<hull::Coordinate>(open_surface.size())),
+        qh::Error);
+  }
+}
+
 TEST_CASE("Animals STL") {
   auto animal_name = GENERATE("Dolphin", "Eagle", "Giraffe", "Hyppo", "Snake");
 
@@ -27,97 +924,167 @@ TEST_CASE("Animals STL") {
                   qh::ConvexHullContext{2000, std::nullopt});
 }
 
-/////////////////////////////////////////////////////////
-/////////////////// performance tests ///////////////////
-/////////////////////////////////////////////////////////
+TEST_CASE("Binary STL") {
+  auto cloud = importStl(getAnimalStlPath("Dolphin"));
+  REQUIRE(cloud.size() == 672 * 3);
 
-#include <chrono>
-#include <iostream>
+  // store the vertices as the facets of a binary stl, repeating each one
+  // slightly displaced to check the clones are discarded
+  const std::size_t facets = cloud.size() / 3;
+  auto file_name = std::filesystem::temp_directory_path() / "Dolphin.stl";
+  {
+    std::ofstream stream(file_name, std::ios::binary);
+    std::string header(80, ' ');
+    stream.write(header.data(), header.size());
+    const std::uint32_t facets_number = static_cast<std::uint32_t>(facets);
+    stream.write(reinterpret_cast<const char *>(&facets_number),
+                 sizeof(facets_number));
+    for (std::size_t f = 0; f < facets; ++f) {
+      float facet[12] = {0, 0, 1};
+      for (std::size_t v = 0; v < 3; ++v) {
+        std::memcpy(facet + 3 * (v + 1), cloud.data() + 3 * ((f + v) % facets),
+                    3 * sizeof(float));
+      }
+      if (f != 0) {
+        // already imported as the second vertex of the previous facet
+        facet[3] += TOLLERANCE_CLONE * 0.5f;
+      }
+      stream.write(reinterpret_cast<const char *>(facet), sizeof(facet));
+      const std::uint16_t attribute = 0;
+      stream.write(reinterpret_cast<const char *>(&attribute),
+                   sizeof(attribute));
+    }
+  }
 
-struct Durations {
-  using TimeUnit = std::chrono::nanoseconds;
+  auto imported = importStl(file_name);
+  std::filesystem::remove(file_name);
+  CHECK(imported == cloud);
 
-  Durations() = default;
+  qh::HullEngine engine(qh::ConvexHullContext{2000, std::nullopt});
+  CHECK_FALSE(engine.compute(qh::PointsView{imported.data(), facets}).empty());
+}
 
-  template <typename Pred> Durations &add(const Pred &pred) {
-    auto tic = std::chrono::high_resolution_clock::now();
-    pred();
-    auto elapsed = std::chrono::duration_cast<TimeUnit>(
-        std::chrono::high_resolution_clock::now() - tic);
-    auto it = std::upper_bound(samples.begin(), samples.end(), elapsed);
-    samples.insert(it, elapsed);
-    return *this;
+TEST_CASE("ASCII STL") {
+  auto file_name = std::filesystem::temp_directory_path() / "Vertex.stl";
+  {
+    // the keyword also appears in the name of the solid
+    std::ofstream stream(file_name);
+    stream << "solid vertex 9 9 9\n"
+              "  facet normal 0 0 1\n"
+              "    outer loop\n"
+              "      vertex 0 0 0\n"
+              "      vertex 1 0 0\n"
+              "\tvertex 0 1 0\n"
+              "    endloop\n"
+              "  endfacet\n"
+              "endsolid vertices\n";
   }
+  auto imported = importStl(file_name);
+  std::filesystem::remove(file_name);
+  CHECK(imported == std::vector<float>{0, 0, 0, 1, 0, 0, 0, 1, 0});
+}
 
-  template <typename Pred>
-  Durations &addXTimes(const Pred &pred, std::size_t times) {
-    for (std::size_t k = 0; k < times; ++k) {
-      add(pred);
+TEST_CASE("Hull files") {
+  auto cloud = importStl(getAnimalStlPath("Eagle"));
+  const qh::PointsView view{cloud.data(), cloud.size() / 3};
+  std::vector<hull::Coordinate> normals;
+  auto incidences = qh::convex_hull(view, normals);
+
+  using Writer = void (*)(const std::filesystem::path &,
+                          const qh::PointsView &,
+                          const std::vector<qh::FacetIncidences> &,
+                          const std::vector<hull::Coordinate> &);
+  using Reader = HullFile (*)(const std::filesystem::path &);
+  auto [extension, writer, reader] =
+      GENERATE(std::make_tuple(".ply", Writer{writePly}, Reader{readPly}),
+               std::make_tuple(".obj", Writer{writeObj}, Reader{readObj}),
+               std::make_tuple(".qhb", Writer{writeCompact},
+                               Reader{readCompact}));
+  auto file_name =
+      std::filesystem::temp_directory_path() / (std::string{"Eagle"} +
+                                                extension);
+
+  auto same_normals = [](const std::vector<hull::Coordinate> &a,
+                         const std::vector<hull::Coordinate> &b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(),
+                      [](const hull::Coordinate &u, const hull::Coordinate &v) {
+                        return u.x == v.x && u.y == v.y && u.z == v.z;
+                      });
+  };
+
+  SECTION("With normals") {
+    writer(file_name, view, incidences, normals);
+    auto read = reader(file_name);
+    // floats are written in their shortest exact form also by the obj writer
+    CHECK(read.cloud == cloud);
+    CHECK(read.incidences == incidences);
+    CHECK(same_normals(read.normals, normals));
+  }
+
+  SECTION("Without normals, from a strided view") {
+    std::vector<float> interleaved;
+    for (std::size_t k = 0; k < cloud.size(); k += 3) {
+      interleaved.insert(interleaved.end(), cloud.begin() + k,
+                         cloud.begin() + k + 3);
+      interleaved.push_back(0);
     }
-    return *this;
+    writer(file_name, qh::PointsView{interleaved.data(), view.size, 4},
+           incidences, {});
+    auto read = reader(file_name);
+    CHECK(read.cloud == cloud);
+    CHECK(read.incidences == incidences);
+    CHECK(read.normals.empty());
   }
 
-  struct Stats {
-    TimeUnit average;
-    TimeUnit min;
-    TimeUnit max;
-  };
-  Stats getStats() const {
-    Stats res;
-    res.min = samples.front();
-    res.max = samples.back();
-    double average = 0;
-    for (const auto &sample : samples) {
-      average += static_cast<double>(sample.count()) /
-                 static_cast<double>(samples.size());
-    }
-    res.average = TimeUnit{static_cast<int>(round(average))};
-    return res;
-  }
-
-private:
-  std::vector<TimeUnit> samples;
-};
-
-std::ostream &operator<<(std::ostream &recipient,
-                         const Durations::Stats &stats) {
-  auto convert_time = [](const Durations::TimeUnit &t) {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(t);
+  SECTION("Malformed file") {
+    writer(file_name, view, incidences, normals);
+    if (std::string{extension} == ".obj") {
+      std::ofstream stream(file_name, std::ios::app);
+      stream << "f 1 2\n";
+    } else {
+      std::filesystem::resize_file(file_name,
+                                   std::filesystem::file_size(file_name) - 7);
+    }
+    CHECK_THROWS_AS(reader(file_name), std::runtime_error);
+  }
+
+  std::filesystem::remove(file_name);
+}
+
+TEST_CASE("Malformed PLY files") {
+  auto file_name = std::filesystem::temp_directory_path() / "Malformed.ply";
+  auto write = [&](const std::string &elements, const auto &...values) {
+    std::ofstream stream(file_name, std::ios::binary);
+    stream << "ply\nformat binary_little_endian 1.0\n"
+           << elements << "end_header\n";
+    (stream.write(reinterpret_cast<const char *>(&values), sizeof(values)),
+     ...);
   };
+  const std::string vertex =
+      "element vertex 1\nproperty float x\nproperty float y\n"
+      "property float z\n";
+  const std::string face =
+      "element face 1\nproperty list uchar float vertex_indices\n";
+
+  SECTION("Empty list") {
+    write("element vertex 1\nproperty list uchar float x\n", std::uint8_t{0});
+  }
+
+  SECTION("Negative index") {
+    write(vertex + face, 0.f, 0.f, 0.f, std::uint8_t{3}, 0.f, -1.f, 0.f);
+  }
+
+  SECTION("Not a number index") {
+    write(vertex + face, 0.f, 0.f, 0.f, std::uint8_t{3}, 0.f,
+          std::numeric_limits<float>::quiet_NaN(), 0.f);
+  }
 
-  return recipient << "[ " << convert_time(stats.min).count() << " , "
-                   << convert_time(stats.max).count() << " ] (ms)  average "
-                   << convert_time(stats.average).count() << " (ms)";
-}
-
-/*
-TEST_CASE("Profiling serial vs mt", "[!mayfail]") {
-  const std::size_t trials = 10;
-  auto cloud = sampleCloud(50000);
-
-  Durations::Stats serial_times =
-      Durations{}
-          .addXTimes(
-              [&]() {
-                qh::convex_hull(cloud.begin(), cloud.end(), to_hull_coordinate,
-                                qh::ConvexHullContext{10000, std::nullopt});
-              },
-              trials)
-          .getStats();
-  std::cout << "Serial         " << serial_times << std::endl;
-
-  Durations::Stats mt_times =
-      Durations{}
-          .addXTimes(
-              [&]() {
-                qh::convex_hull(cloud.begin(), cloud.end(), to_hull_coordinate,
-                                qh::ConvexHullContext{
-                                    10000, std::make_optional<std::size_t>(2)});
-              },
-              trials)
-          .getStats();
-  std::cout << "Multi Threaded " << serial_times << std::endl;
-
-  CHECK(serial_times.average < mt_times.average);
-}
-*/
\ No newline at end of file
+  SECTION("Size exceeding the data") {
+    // nothing should be reserved for the declared vertices
+    write("element vertex 1000000000000000\nproperty float x\n", 0.f);
+  }
+
+  CHECK_THROWS_AS(readPly(file_name), std::runtime_error);
+  std::filesystem::remove(file_name);
+}
@@ -0,0 +1,745 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include "HullFiles.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+bool is_little_endian() {
+  const std::uint16_t probe = 1;
+  return *reinterpret_cast<const unsigned char *>(&probe) == 1;
+}
+
+const bool LITTLE_ENDIAN_HOST = is_little_endian();
+
+// store value in little endian order, returning the next position
+template <typename T> char *put(char *cursor, const T value) {
+  std::memcpy(cursor, &value, sizeof(T));
+  if (!LITTLE_ENDIAN_HOST) {
+    std::reverse(cursor, cursor + sizeof(T));
+  }
+  return cursor + sizeof(T);
+}
+
+template <typename T> const char *get(const char *cursor, T &value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, cursor, sizeof(T));
+  if (!LITTLE_ENDIAN_HOST) {
+    std::reverse(bytes, bytes + sizeof(T));
+  }
+  std::memcpy(&value, bytes, sizeof(T));
+  return cursor + sizeof(T);
+}
+
+template <typename T>
+const char *get(const char *cursor, T *values, const std::size_t size) {
+  std::memcpy(values, cursor, size * sizeof(T));
+  if (!LITTLE_ENDIAN_HOST) {
+    for (std::size_t k = 0; k < size; ++k) {
+      char *bytes = reinterpret_cast<char *>(values + k);
+      std::reverse(bytes, bytes + sizeof(T));
+    }
+  }
+  return cursor + size * sizeof(T);
+}
+
+void write_file(const std::filesystem::path &fileName,
+                const std::vector<char> &content) {
+  std::ofstream stream(fileName, std::ios::binary);
+  if (!stream.is_open()) {
+    throw std::runtime_error{fileName.string() + " is an invalid filename"};
+  }
+  stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+  if (!stream) {
+    throw std::runtime_error{fileName.string() + " can't be written"};
+  }
+}
+
+const float *point_at(const qh::PointsView &cloud, const std::size_t index) {
+  return cloud.data + index * cloud.stride;
+}
+
+void check_sizes(const qh::PointsView &cloud,
+                 const std::vector<qh::FacetIncidences> &incidences,
+                 const std::vector<hull::Coordinate> &normals) {
+  if (std::numeric_limits<std::uint32_t>::max() < cloud.size) {
+    throw std::runtime_error{"Too many points to be indexed by 32 bits"};
+  }
+  if (!normals.empty() && normals.size() != incidences.size()) {
+    throw std::runtime_error{"Normals and incidences of different sizes"};
+  }
+}
+
+char *put_triplet(char *cursor, const hull::Coordinate &normal) {
+  cursor = put(cursor, normal.x);
+  cursor = put(cursor, normal.y);
+  return put(cursor, normal.z);
+}
+
+char *put_triplet(char *cursor, const qh::FacetIncidences &facet) {
+  for (const std::size_t index : facet) {
+    cursor = put(cursor, static_cast<std::uint32_t>(index));
+  }
+  return cursor;
+}
+
+char *put_points(char *cursor, const qh::PointsView &cloud) {
+  if (cloud.stride == 3 && LITTLE_ENDIAN_HOST) {
+    const std::size_t bytes = cloud.size * 3 * sizeof(float);
+    std::memcpy(cursor, cloud.data, bytes);
+    return cursor + bytes;
+  }
+  for (std::size_t k = 0; k < cloud.size; ++k) {
+    const float *point = point_at(cloud, k);
+    for (std::size_t c = 0; c < 3; ++c) {
+      cursor = put(cursor, point[c]);
+    }
+  }
+  return cursor;
+}
+} // namespace
+
+void writePly(const std::filesystem::path &fileName,
+              const qh::PointsView &cloud,
+              const std::vector<qh::FacetIncidences> &incidences,
+              const std::vector<hull::Coordinate> &normals) {
+  check_sizes(cloud, incidences, normals);
+  std::string header = "ply\n"
+                       "format binary_little_endian 1.0\n"
+                       "comment Fast-Quick-Hull convex hull\n";
+  header += "element vertex " + std::to_string(cloud.size) + '\n';
+  header += "property float x\n"
+            "property float y\n"
+            "property float z\n";
+  header += "element face " + std::to_string(incidences.size()) + '\n';
+  header += "property list uchar uint vertex_indices\n";
+  if (!normals.empty()) {
+    header += "property float nx\n"
+              "property float ny\n"
+              "property float nz\n";
+  }
+  header += "end_header\n";
+
+  const std::size_t face_size =
+      1 + 3 * sizeof(std::uint32_t) + (normals.empty() ? 0 : 3 * sizeof(float));
+  std::vector<char> content(header.size() + cloud.size * 3 * sizeof(float) +
+                            incidences.size() * face_size);
+  char *cursor = std::copy(header.begin(), header.end(), content.data());
+  cursor = put_points(cursor, cloud);
+  for (std::size_t f = 0; f < incidences.size(); ++f) {
+    cursor = put(cursor, std::uint8_t{3});
+    cursor = put_triplet(cursor, incidences[f]);
+    if (!normals.empty()) {
+      cursor = put_triplet(cursor, normals[f]);
+    }
+  }
+  write_file(fileName, content);
+}
+
+namespace {
+void append_float(std::vector<char> &content, const float value) {
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  content.push_back(' ');
+  content.insert(content.end(), buffer, result.ptr);
+}
+
+void append_index(std::vector<char> &content, const std::size_t value) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  content.insert(content.end(), buffer, result.ptr);
+}
+
+void append_triplet(std::vector<char> &content, const std::string_view tag,
+                    const float x, const float y, const float z) {
+  content.insert(content.end(), tag.begin(), tag.end());
+  append_float(content, x);
+  append_float(content, y);
+  append_float(content, z);
+  content.push_back('\n');
+}
+} // namespace
+
+void writeObj(const std::filesystem::path &fileName,
+              const qh::PointsView &cloud,
+              const std::vector<qh::FacetIncidences> &incidences,
+              const std::vector<hull::Coordinate> &normals) {
+  check_sizes(cloud, incidences, normals);
+  std::vector<char> content;
+  content.reserve(40 * (cloud.size + normals.size()) + 40 * incidences.size());
+  const std::string_view header = "# Fast-Quick-Hull convex hull\n";
+  content.insert(content.end(), header.begin(), header.end());
+  for (std::size_t k = 0; k < cloud.size; ++k) {
+    const float *point = point_at(cloud, k);
+    append_triplet(content, "v", point[0], point[1], point[2]);
+  }
+  for (const auto &normal : normals) {
+    append_triplet(content, "vn", normal.x, normal.y, normal.z);
+  }
+  for (std::size_t f = 0; f < incidences.size(); ++f) {
+    content.push_back('f');
+    for (const std::size_t index : incidences[f]) {
+      content.push_back(' ');
+      append_index(content, index + 1);
+      if (!normals.empty()) {
+        content.push_back('/');
+        content.push_back('/');
+        append_index(content, f + 1);
+      }
+    }
+    content.push_back('\n');
+  }
+  write_file(fileName, content);
+}
+
+namespace {
+constexpr std::string_view COMPACT_TAG = "QHULLBIN";
+constexpr std::uint32_t COMPACT_VERSION = 1;
+constexpr std::uint32_t COMPACT_NORMALS_FLAG = 1;
+constexpr std::size_t COMPACT_HEADER_SIZE = 32;
+} // namespace
+
+void writeCompact(const std::filesystem::path &fileName,
+                  const qh::PointsView &cloud,
+                  const std::vector<qh::FacetIncidences> &incidences,
+                  const std::vector<hull::Coordinate> &normals) {
+  check_sizes(cloud, incidences, normals);
+  std::vector<char> content(
+      COMPACT_HEADER_SIZE + cloud.size * 3 * sizeof(float) +
+      incidences.size() * 3 * sizeof(std::uint32_t) +
+      normals.size() * 3 * sizeof(float));
+  char *cursor =
+      std::copy(COMPACT_TAG.begin(), COMPACT_TAG.end(), content.data());
+  cursor = put(cursor, COMPACT_VERSION);
+  cursor = put(cursor, normals.empty() ? std::uint32_t{0}
+                                       : COMPACT_NORMALS_FLAG);
+  cursor = put(cursor, static_cast<std::uint64_t>(cloud.size));
+  cursor = put(cursor, static_cast<std::uint64_t>(incidences.size()));
+  cursor = put_points(cursor, cloud);
+  for (const auto &facet : incidences) {
+    cursor = put_triplet(cursor, facet);
+  }
+  for (const auto &normal : normals) {
+    cursor = put_triplet(cursor, normal);
+  }
+  write_file(fileName, content);
+}
+
+namespace {
+[[noreturn]] void throw_malformed(const std::filesystem::path &fileName,
+                                  const std::string &reason) {
+  throw std::runtime_error{fileName.string() + " is malformed: " + reason};
+}
+
+void check_indices(const std::filesystem::path &fileName,
+                   const HullFile &result) {
+  const std::size_t points = result.cloud.size() / 3;
+  for (const auto &facet : result.incidences) {
+    for (const std::size_t index : facet) {
+      if (points <= index) {
+        throw_malformed(fileName, "out of range vertex index");
+      }
+    }
+  }
+}
+} // namespace
+
+HullFile readCompact(const std::filesystem::path &fileName) {
+  MappedFile file(fileName);
+  const std::string_view content = file.view();
+  if (content.size() < COMPACT_HEADER_SIZE ||
+      content.substr(0, COMPACT_TAG.size()) != COMPACT_TAG) {
+    throw_malformed(fileName, "missing header");
+  }
+  const char *cursor = content.data() + COMPACT_TAG.size();
+  std::uint32_t version, flags;
+  std::uint64_t points, facets;
+  cursor = get(cursor, version);
+  cursor = get(cursor, flags);
+  cursor = get(cursor, points);
+  cursor = get(cursor, facets);
+  if (version != COMPACT_VERSION) {
+    throw_malformed(fileName, "unsupported version");
+  }
+  const bool has_normals = (flags & COMPACT_NORMALS_FLAG) != 0;
+  const std::uint64_t available = content.size() - COMPACT_HEADER_SIZE;
+  const std::uint64_t triplets = available / 12;
+  // facets are compared before being multiplied, not to overflow
+  if (available % 12 != 0 || triplets < points ||
+      triplets - points < facets ||
+      triplets - points != facets * (has_normals ? 2 : 1)) {
+    throw_malformed(fileName, "unexpected size");
+  }
+
+  HullFile result;
+  result.cloud.resize(points * 3);
+  cursor = get(cursor, result.cloud.data(), result.cloud.size());
+  std::vector<std::uint32_t> indices(facets * 3);
+  cursor = get(cursor, indices.data(), indices.size());
+  result.incidences.resize(facets);
+  for (std::size_t f = 0; f < facets; ++f) {
+    for (std::size_t c = 0; c < 3; ++c) {
+      result.incidences[f][c] = indices[3 * f + c];
+    }
+  }
+  if (has_normals) {
+    result.normals.resize(facets);
+    for (auto &normal : result.normals) {
+      cursor = get(cursor, normal.x);
+      cursor = get(cursor, normal.y);
+      cursor = get(cursor, normal.z);
+    }
+  }
+  check_indices(fileName, result);
+  return result;
+}
+
+namespace {
+enum class PlyType { INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT, DOUBLE };
+
+std::size_t size_of(const PlyType type) {
+  switch (type) {
+  case PlyType::INT8:
+  case PlyType::UINT8:
+    return 1;
+  case PlyType::INT16:
+  case PlyType::UINT16:
+    return 2;
+  case PlyType::DOUBLE:
+    return 8;
+  default:
+    break;
+  }
+  return 4;
+}
+
+struct PlyProperty {
+  std::string name;
+  PlyType type;
+  // list properties only
+  std::optional<PlyType> count_type;
+};
+
+struct PlyElement {
+  std::string name;
+  std::size_t size;
+  std::vector<PlyProperty> properties;
+};
+
+std::vector<std::string_view> split(std::string_view line) {
+  std::vector<std::string_view> tokens;
+  while (!line.empty()) {
+    const std::size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) {
+      break;
+    }
+    line.remove_prefix(begin);
+    const std::size_t end = std::min(line.find_first_of(" \t\r"), line.size());
+    tokens.push_back(line.substr(0, end));
+    line.remove_prefix(end);
+  }
+  return tokens;
+}
+
+class PlyParser {
+public:
+  PlyParser(const std::filesystem::path &fileName, std::string_view content)
+      : fileName(fileName), content(content) {}
+
+  HullFile parse() {
+    parseHeader();
+    HullFile result;
+    for (const auto &element : elements) {
+      if (element.name == "vertex") {
+        parseVertices(element, result);
+      } else if (element.name == "face") {
+        parseFaces(element, result);
+      } else {
+        checkFits(element);
+        for (std::size_t k = 0; k < element.size; ++k) {
+          for (const auto &property : element.properties) {
+            readProperty(property);
+          }
+        }
+      }
+    }
+    if (result.normals.size() != result.incidences.size()) {
+      result.normals.clear();
+    }
+    check_indices(fileName, result);
+    return result;
+  }
+
+private:
+  std::string_view nextLine() {
+    const std::size_t end = content.find('\n');
+    if (end == std::string_view::npos) {
+      throw_malformed(fileName, "unterminated header");
+    }
+    std::string_view line = content.substr(0, end);
+    content.remove_prefix(end + 1);
+    return line;
+  }
+
+  PlyType typeOf(const std::string_view name) const {
+    static const std::pair<std::string_view, PlyType> types[] = {
+        {"char", PlyType::INT8},     {"int8", PlyType::INT8},
+        {"uchar", PlyType::UINT8},   {"uint8", PlyType::UINT8},
+        {"short", PlyType::INT16},   {"int16", PlyType::INT16},
+        {"ushort", PlyType::UINT16}, {"uint16", PlyType::UINT16},
+        {"int", PlyType::INT32},     {"int32", PlyType::INT32},
+        {"uint", PlyType::UINT32},   {"uint32", PlyType::UINT32},
+        {"float", PlyType::FLOAT},   {"float32", PlyType::FLOAT},
+        {"double", PlyType::DOUBLE}, {"float64", PlyType::DOUBLE}};
+    for (const auto &[label, type] : types) {
+      if (label == name) {
+        return type;
+      }
+    }
+    throw_malformed(fileName, "unknown type " + std::string{name});
+  }
+
+  void parseHeader() {
+    if (nextLine() != "ply") {
+      throw_malformed(fileName, "not a PLY file");
+    }
+    while (true) {
+      const auto tokens = split(nextLine());
+      if (tokens.empty() || tokens.front() == "comment" ||
+          tokens.front() == "obj_info") {
+        continue;
+      }
+      if (tokens.front() == "end_header") {
+        return;
+      }
+      if (tokens.front() == "format") {
+        if (tokens.size() < 2 || tokens[1] != "binary_little_endian") {
+          throw_malformed(fileName, "only binary little endian is supported");
+        }
+      } else if (tokens.front() == "element" && tokens.size() == 3) {
+        PlyElement element{std::string{tokens[1]}, 0, {}};
+        const auto parsed =
+            std::from_chars(tokens[2].data(),
+                            tokens[2].data() + tokens[2].size(), element.size);
+        if (parsed.ec != std::errc{}) {
+          throw_malformed(fileName, "invalid element size");
+        }
+        elements.push_back(std::move(element));
+      } else if (tokens.front() == "property" && !elements.empty() &&
+                 (tokens.size() == 3 ||
+                  (tokens.size() == 5 && tokens[1] == "list"))) {
+        PlyProperty property;
+        property.name = std::string{tokens.back()};
+        if (tokens.size() == 5) {
+          property.count_type = typeOf(tokens[2]);
+          property.type = typeOf(tokens[3]);
+        } else {
+          property.type = typeOf(tokens[1]);
+        }
+        elements.back().properties.push_back(std::move(property));
+      } else {
+        throw_malformed(fileName, "invalid header line");
+      }
+    }
+  }
+
+  double readValue(const PlyType type) {
+    if (content.size() < size_of(type)) {
+      throw_malformed(fileName, "truncated data");
+    }
+    const char *cursor = content.data();
+    double result = 0;
+    auto read = [&](auto value) {
+      get(cursor, value);
+      result = static_cast<double>(value);
+    };
+    switch (type) {
+    case PlyType::INT8:
+      read(std::int8_t{});
+      break;
+    case PlyType::UINT8:
+      read(std::uint8_t{});
+      break;
+    case PlyType::INT16:
+      read(std::int16_t{});
+      break;
+    case PlyType::UINT16:
+      read(std::uint16_t{});
+      break;
+    case PlyType::INT32:
+      read(std::int32_t{});
+      break;
+    case PlyType::UINT32:
+      read(std::uint32_t{});
+      break;
+    case PlyType::FLOAT:
+      read(float{});
+      break;
+    case PlyType::DOUBLE:
+      read(double{});
+      break;
+    }
+    content.remove_prefix(size_of(type));
+    return result;
+  }
+
+  // non negative integral value, representable as a std::size_t
+  std::size_t toSize(const double value) const {
+    // 2^53: beyond it, doubles are not anymore contiguous integers
+    static constexpr double MAX_SIZE = 9007199254740992.0;
+    if (!(0 <= value && value < MAX_SIZE) || std::floor(value) != value) {
+      throw_malformed(fileName, "invalid count or index");
+    }
+    return static_cast<std::size_t>(value);
+  }
+
+  // the values of a list property are all returned, a scalar one is
+  // returned as a single value
+  const std::vector<double> &readProperty(const PlyProperty &property) {
+    values.clear();
+    std::size_t size = 1;
+    if (property.count_type) {
+      size = toSize(readValue(*property.count_type));
+      if (content.size() / size_of(property.type) < size) {
+        throw_malformed(fileName, "truncated data");
+      }
+    }
+    for (std::size_t k = 0; k < size; ++k) {
+      values.push_back(readValue(property.type));
+    }
+    return values;
+  }
+
+  double readScalar(const PlyProperty &property) {
+    const auto &read = readProperty(property);
+    if (read.empty()) {
+      throw_malformed(fileName, "empty list for property " + property.name);
+    }
+    return read.front();
+  }
+
+  // every record takes at least one value per property: the declared size
+  // is checked against the remaining data before reserving any memory
+  void checkFits(const PlyElement &element) const {
+    std::size_t record_size = 0;
+    for (const auto &property : element.properties) {
+      record_size += size_of(property.count_type.value_or(property.type));
+    }
+    if (record_size == 0) {
+      if (element.size != 0) {
+        throw_malformed(fileName, "element without properties");
+      }
+      return;
+    }
+    if (content.size() / record_size < element.size) {
+      throw_malformed(fileName, "truncated data");
+    }
+  }
+
+  void parseVertices(const PlyElement &element, HullFile &result) {
+    static const std::string_view names[3] = {"x", "y", "z"};
+    checkFits(element);
+    result.cloud.reserve(result.cloud.size() + element.size * 3);
+    for (std::size_t k = 0; k < element.size; ++k) {
+      float point[3] = {0, 0, 0};
+      for (const auto &property : element.properties) {
+        const double value = readScalar(property);
+        for (std::size_t c = 0; c < 3; ++c) {
+          if (property.name == names[c]) {
+            point[c] = static_cast<float>(value);
+          }
+        }
+      }
+      result.cloud.insert(result.cloud.end(), point, point + 3);
+    }
+  }
+
+  void parseFaces(const PlyElement &element, HullFile &result) {
+    checkFits(element);
+    result.incidences.reserve(element.size);
+    result.normals.reserve(element.size);
+    for (std::size_t k = 0; k < element.size; ++k) {
+      qh::FacetIncidences facet;
+      hull::Coordinate normal;
+      std::size_t normal_components = 0;
+      for (const auto &property : element.properties) {
+        if (property.name == "vertex_indices" ||
+            property.name == "vertex_index") {
+          const auto &read = readProperty(property);
+          if (read.size() != 3) {
+            throw_malformed(fileName, "only triangular faces are supported");
+          }
+          for (std::size_t c = 0; c < 3; ++c) {
+            facet[c] = toSize(read[c]);
+          }
+        } else if (property.name == "nx") {
+          normal.x = static_cast<float>(readScalar(property));
+          ++normal_components;
+        } else if (property.name == "ny") {
+          normal.y = static_cast<float>(readScalar(property));
+          ++normal_components;
+        } else if (property.name == "nz") {
+          normal.z = static_cast<float>(readScalar(property));
+          ++normal_components;
+        } else {
+          readProperty(property);
+        }
+      }
+      result.incidences.push_back(facet);
+      if (normal_components == 3) {
+        result.normals.push_back(normal);
+      }
+    }
+  }
+
+  const std::filesystem::path &fileName;
+  std::string_view content;
+  std::vector<PlyElement> elements;
+  std::vector<double> values;
+};
+} // namespace
+
+HullFile readPly(const std::filesystem::path &fileName) {
+  MappedFile file(fileName);
+  return PlyParser{fileName, file.view()}.parse();
+}
+
+namespace {
+class ObjParser {
+public:
+  ObjParser(const std::filesystem::path &fileName, std::string_view content)
+      : fileName(fileName), content(content) {}
+
+  HullFile parse() {
+    HullFile result;
+    std::vector<hull::Coordinate> normals;
+    std::vector<std::size_t> facets_normal;
+    while (!content.empty()) {
+      const std::size_t end = std::min(content.find('\n'), content.size());
+      line = content.substr(0, end);
+      content.remove_prefix(std::min(end + 1, content.size()));
+      const auto tag = nextToken();
+      if (tag == "v") {
+        for (std::size_t c = 0; c < 3; ++c) {
+          result.cloud.push_back(nextFloat());
+        }
+      } else if (tag == "vn") {
+        auto &normal = normals.emplace_back();
+        normal.x = nextFloat();
+        normal.y = nextFloat();
+        normal.z = nextFloat();
+      } else if (tag == "f") {
+        qh::FacetIncidences facet;
+        std::optional<std::size_t> normal;
+        for (std::size_t c = 0; c < 3; ++c) {
+          facet[c] = parseVertex(nextToken(), result.cloud.size() / 3,
+                                 normals.size(), normal);
+        }
+        if (!nextToken().empty()) {
+          throw_malformed(fileName, "only triangular faces are supported");
+        }
+        result.incidences.push_back(facet);
+        facets_normal.push_back(
+            normal.value_or(std::numeric_limits<std::size_t>::max()));
+      }
+    }
+    // normals are kept only when given for each facet
+    if (std::all_of(facets_normal.begin(), facets_normal.end(),
+                    [&normals](const std::size_t index) {
+                      return index < normals.size();
+                    })) {
+      result.normals.reserve(facets_normal.size());
+      for (const std::size_t index : facets_normal) {
+        result.normals.push_back(normals[index]);
+      }
+    }
+    check_indices(fileName, result);
+    return result;
+  }
+
+private:
+  std::string_view nextToken() {
+    const std::size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) {
+      line = std::string_view{};
+      return line;
+    }
+    line.remove_prefix(begin);
+    const std::size_t end = std::min(line.find_first_of(" \t\r"), line.size());
+    const auto token = line.substr(0, end);
+    line.remove_prefix(end);
+    return token;
+  }
+
+  float nextFloat() {
+    const auto token = nextToken();
+    float value = 0;
+    const auto parsed =
+        std::from_chars(token.data(), token.data() + token.size(), value);
+    if (token.empty() || parsed.ec != std::errc{}) {
+      throw_malformed(fileName, "invalid coordinate");
+    }
+    return value;
+  }
+
+  // OBJ indices are 1 based, or relative to the end when negative
+  std::size_t toIndex(const std::string_view token, const std::size_t size) {
+    long long value = 0;
+    const auto parsed =
+        std::from_chars(token.data(), token.data() + token.size(), value);
+    if (token.empty() || parsed.ec != std::errc{} || value == 0) {
+      throw_malformed(fileName, "invalid index");
+    }
+    const long long index =
+        0 < value ? value - 1 : static_cast<long long>(size) + value;
+    if (index < 0) {
+      throw_malformed(fileName, "invalid index");
+    }
+    return static_cast<std::size_t>(index);
+  }
+
+  // parses v, v/vt, v//vn or v/vt/vn, storing the normal of the first
+  // vertex having one
+  std::size_t parseVertex(const std::string_view token,
+                          const std::size_t points, const std::size_t normals,
+                          std::optional<std::size_t> &normal) {
+    if (token.empty()) {
+      throw_malformed(fileName, "only triangular faces are supported");
+    }
+    const std::size_t first_slash = token.find('/');
+    const std::size_t vertex = toIndex(token.substr(0, first_slash), points);
+    if (first_slash != std::string_view::npos) {
+      const std::size_t second_slash = token.find('/', first_slash + 1);
+      if (second_slash != std::string_view::npos && !normal) {
+        normal = toIndex(token.substr(second_slash + 1), normals);
+      }
+    }
+    return vertex;
+  }
+
+  const std::filesystem::path &fileName;
+  std::string_view content;
+  std::string_view line;
+};
+} // namespace
+
+HullFile readObj(const std::filesystem::path &fileName) {
+  MappedFile file(fileName);
+  return ObjParser{fileName, file.view()}.parse();
+}
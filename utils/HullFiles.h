@@ -0,0 +1,71 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <QuickHull/FastQuickHull.h>
+
+#include <filesystem>
+#include <vector>
+
+/** @brief A convex hull together with the cloud it was computed from, as
+ * read from the files written by the functions below.
+ */
+struct HullFile {
+  // x, y, z of each point
+  std::vector<float> cloud;
+  std::vector<qh::FacetIncidences> incidences;
+  // empty when the file stores no normals
+  std::vector<hull::Coordinate> normals;
+};
+
+/** @brief Alternatives to logConvexhull, suited for big clouds: each file is
+ * assembled in memory and then written at once. normals can be empty, in
+ * which case they are not written.
+ * The points of the cloud are all written, the vertices of the hull being
+ * the ones referred by the incidences.
+ * @throw std::runtime_error when the file can't be written, or the cloud has
+ * more points than a 32 bits index can refer to.
+ */
+
+// Binary little endian PLY: the cloud is the vertex element, while each
+// facet is a face element with its normal as nx, ny, nz properties.
+void writePly(const std::filesystem::path &fileName,
+              const qh::PointsView &cloud,
+              const std::vector<qh::FacetIncidences> &incidences,
+              const std::vector<hull::Coordinate> &normals);
+
+// Wavefront OBJ: a v line for each point, a vn line for each normal and an f
+// line for each facet.
+void writeObj(const std::filesystem::path &fileName,
+              const qh::PointsView &cloud,
+              const std::vector<qh::FacetIncidences> &incidences,
+              const std::vector<hull::Coordinate> &normals);
+
+// Compact little endian format, made of:
+//  - a 32 bytes header: the "QHULLBIN" tag, the version (uint32, 1),
+//    the flags (uint32, 1 when normals are stored), the number of points and
+//    the number of facets (uint64 both)
+//  - the coordinates of the points, as float32 triplets
+//  - the incidences of the facets, as uint32 triplets
+//  - the normals of the facets, as float32 triplets, if stored
+void writeCompact(const std::filesystem::path &fileName,
+                  const qh::PointsView &cloud,
+                  const std::vector<qh::FacetIncidences> &incidences,
+                  const std::vector<hull::Coordinate> &normals);
+
+/** @brief Read the files written by the functions above, memory mapping
+ * them when possible. readPly also accepts other binary little endian PLY
+ * files made of triangles, while readObj any OBJ file made of triangles: in
+ * both cases, the normals are read only when given for each facet.
+ * @throw std::runtime_error when the file can't be read or is malformed.
+ */
+HullFile readPly(const std::filesystem::path &fileName);
+
+HullFile readObj(const std::filesystem::path &fileName);
+
+HullFile readCompact(const std::filesystem::path &fileName);
@@ -0,0 +1,63 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include "MappedFile.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path &fileName) {
+#ifdef MAPPED_FILE_MMAP
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error{fileName.string() + " is an invalid filename"};
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw std::runtime_error{fileName.string() + " can't be inspected"};
+  }
+  size = static_cast<std::size_t>(info.st_size);
+  if (size != 0) {
+    void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      ::madvise(mapped, size, MADV_SEQUENTIAL);
+      mapping = mapped;
+      data = static_cast<const char *>(mapped);
+    }
+  }
+  ::close(fd);
+  if (data != nullptr || size == 0) {
+    return;
+  }
+#endif
+  std::ifstream stream(fileName, std::ios::binary);
+  if (!stream.is_open()) {
+    throw std::runtime_error{fileName.string() + " is an invalid filename"};
+  }
+  buffer.assign(std::istreambuf_iterator<char>(stream),
+                std::istreambuf_iterator<char>());
+  data = buffer.data();
+  size = buffer.size();
+}
+
+MappedFile::~MappedFile() {
+#ifdef MAPPED_FILE_MMAP
+  if (mapping != nullptr) {
+    ::munmap(mapping, size);
+  }
+#endif
+}
@@ -0,0 +1,33 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+/** @brief Read only view of a whole file: memory mapped when supported,
+ * otherwise loaded into a buffer.
+ */
+class MappedFile {
+public:
+  MappedFile(const std::filesystem::path &fileName);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  std::string_view view() const { return std::string_view{data, size}; }
+
+private:
+  void *mapping = nullptr;
+  std::vector<char> buffer;
+  const char *data = nullptr;
+  std::size_t size = 0;
+};
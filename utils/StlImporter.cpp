@@ -0,0 +1,200 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#include "StlImporter.h"
+#include "MappedFile.h"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+// Spatial hash grid with cells as wide as TOLLERANCE_CLONE: the clones of a
+// vertex can only be in the same cell or in one of the 26 adjacent ones.
+class ClonesFilter {
+public:
+  ClonesFilter(const StlVertexPredicate &pred) : pred(pred) {}
+
+  void reserve(std::size_t size) {
+    vertices.reserve(size);
+    next.reserve(size);
+    heads.reserve(size);
+  }
+
+  void add(const std::array<float, 3> &vertex) {
+    Cell cell;
+    for (std::size_t c = 0; c < 3; ++c) {
+      cell[c] = static_cast<std::int64_t>(
+          std::floor(vertex[c] / TOLLERANCE_CLONE));
+    }
+    for (std::int64_t dx = -1; dx <= 1; ++dx) {
+      for (std::int64_t dy = -1; dy <= 1; ++dy) {
+        for (std::int64_t dz = -1; dz <= 1; ++dz) {
+          auto it = heads.find(Cell{cell[0] + dx, cell[1] + dy, cell[2] + dz});
+          if (it == heads.end()) {
+            continue;
+          }
+          for (std::size_t k = it->second; k != NONE; k = next[k]) {
+            if (squared_distance(vertices[k], vertex) <=
+                TOLLERANCE_CLONE * TOLLERANCE_CLONE) {
+              return;
+            }
+          }
+        }
+      }
+    }
+    auto head = heads.emplace(cell, NONE).first;
+    next.push_back(head->second);
+    head->second = vertices.size();
+    vertices.push_back(vertex);
+    pred(vertex[0], vertex[1], vertex[2]);
+  }
+
+private:
+  using Cell = std::array<std::int64_t, 3>;
+
+  struct CellHasher {
+    std::size_t operator()(const Cell &cell) const {
+      std::uint64_t result = static_cast<std::uint64_t>(cell[0]);
+      result = result * 73856093u ^ static_cast<std::uint64_t>(cell[1]);
+      result = result * 19349663u ^ static_cast<std::uint64_t>(cell[2]);
+      return static_cast<std::size_t>(result * 83492791u);
+    }
+  };
+
+  static float squared_distance(const std::array<float, 3> &a,
+                                const std::array<float, 3> &b) {
+    float result = 0;
+    for (std::size_t c = 0; c < 3; ++c) {
+      result += (a[c] - b[c]) * (a[c] - b[c]);
+    }
+    return result;
+  }
+
+  static constexpr std::size_t NONE = static_cast<std::size_t>(-1);
+
+  const StlVertexPredicate &pred;
+  std::vector<std::array<float, 3>> vertices;
+  // next[k] is the vertex following the k-th one in the same cell
+  std::vector<std::size_t> next;
+  std::unordered_map<Cell, std::size_t, CellHasher> heads;
+};
+
+static constexpr std::size_t BINARY_HEADER_SIZE = 80;
+static constexpr std::size_t BINARY_FACET_SIZE = 50;
+
+bool is_binary(const std::string_view &content, std::size_t &facets) {
+  if (content.size() < BINARY_HEADER_SIZE + sizeof(std::uint32_t)) {
+    return false;
+  }
+  std::uint32_t facets_number;
+  std::memcpy(&facets_number, content.data() + BINARY_HEADER_SIZE,
+              sizeof(std::uint32_t));
+  facets = facets_number;
+  // many binary files start with "solid" as well: rely on the size
+  return content.size() == BINARY_HEADER_SIZE + sizeof(std::uint32_t) +
+                               facets * BINARY_FACET_SIZE;
+}
+
+void parse_binary(const std::string_view &content, std::size_t facets,
+                  ClonesFilter &filter) {
+  filter.reserve(facets / 2);
+  const char *cursor =
+      content.data() + BINARY_HEADER_SIZE + sizeof(std::uint32_t);
+  std::array<float, 3> vertex;
+  for (std::size_t f = 0; f < facets; ++f, cursor += BINARY_FACET_SIZE) {
+    // skip the normal
+    const char *vertices = cursor + sizeof(vertex);
+    for (std::size_t v = 0; v < 3; ++v) {
+      std::memcpy(vertex.data(), vertices + v * sizeof(vertex),
+                  sizeof(vertex));
+      filter.add(vertex);
+    }
+  }
+}
+
+bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+const char *parse_float(const char *cursor, const char *end, float &result) {
+  while (cursor != end && is_space(*cursor)) {
+    ++cursor;
+  }
+  if (cursor != end && *cursor == '+') {
+    ++cursor;
+  }
+  auto [ptr, ec] = std::from_chars(cursor, end, result);
+  if (ec != std::errc{}) {
+    throw std::runtime_error{"Invalid vertex inside stl file"};
+  }
+  return ptr;
+}
+
+// true when the tag at pos is the first token of its line, as the keywords
+// of the format are: the same word can appear anywhere in a solid name
+bool is_keyword(const std::string_view &content, std::size_t pos,
+                std::size_t size) {
+  const std::size_t next = pos + size;
+  if (next < content.size() && !is_space(content[next])) {
+    return false;
+  }
+  while (pos != 0 && content[pos - 1] != '\n') {
+    --pos;
+    if (!is_space(content[pos])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void parse_ascii(const std::string_view &content, ClonesFilter &filter) {
+  static constexpr std::string_view VERTEX_TAG = "vertex";
+  const char *end = content.data() + content.size();
+  std::array<float, 3> vertex;
+  std::size_t pos = content.find(VERTEX_TAG);
+  while (pos != std::string_view::npos) {
+    if (!is_keyword(content, pos, VERTEX_TAG.size())) {
+      pos = content.find(VERTEX_TAG, pos + VERTEX_TAG.size());
+      continue;
+    }
+    const char *cursor = content.data() + pos + VERTEX_TAG.size();
+    for (auto &coordinate : vertex) {
+      cursor = parse_float(cursor, end, coordinate);
+    }
+    filter.add(vertex);
+    pos = content.find(VERTEX_TAG, cursor - content.data());
+  }
+}
+} // namespace
+
+void importStl(const std::filesystem::path &fileName,
+               const StlVertexPredicate &pred) {
+  MappedFile file(fileName);
+  const auto content = file.view();
+  ClonesFilter filter(pred);
+  std::size_t facets;
+  if (is_binary(content, facets)) {
+    parse_binary(content, facets, filter);
+  } else {
+    parse_ascii(content, filter);
+  }
+}
+
+std::vector<float> importStl(const std::filesystem::path &fileName) {
+  std::vector<float> result;
+  importStl(fileName, [&result](const float x, const float y, const float z) {
+    result.insert(result.end(), {x, y, z});
+  });
+  return result;
+}
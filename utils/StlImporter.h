@@ -0,0 +1,34 @@
+/**
+ * Author:    Andrea Casalino
+ * Created:   03.12.2019
+ *
+ * report any bug to andrecasa91@gmail.com.
+ **/
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+/** @brief Vertices closer than this are considered clones of the same vertex
+ * when importing an STL.
+ */
+static constexpr float TOLLERANCE_CLONE = static_cast<float>(1e-4);
+
+using StlVertexPredicate =
+    std::function<void(const float x, const float y, const float z)>;
+
+/** @brief Parses an .STL file (https://en.wikipedia.org/wiki/STL_(file_format),
+ * either binary or ASCII, passing each distinct vertex to the predicate in
+ * order of first appearance. Vertices closer than TOLLERANCE_CLONE to an
+ * already passed one are skipped.
+ * The file is memory mapped, when possible, and parsed in place.
+ */
+void importStl(const std::filesystem::path &fileName,
+               const StlVertexPredicate &pred);
+
+/** @brief Same as above, returning the distinct vertices as a flat x,y,z
+ * buffer, which can be passed to qh::convex_hull through a qh::PointsView.
+ */
+std::vector<float> importStl(const std::filesystem::path &fileName);
@@ -12,7 +12,6 @@
 #include <math.h>
 #include <mutex>
 #include <random>
-#include <sstream>
 #include <stdexcept>
 
 hull::Coordinate to_hull_coordinate(const Vector3d &to_convert) {
@@ -101,61 +100,12 @@ void logConvexhull(const std::vector<qh::FacetIncidences> &facets_incidences,
   f << '}';
 }
 
-namespace {
-static constexpr float TOLLERANCE_CLONE = static_cast<float>(1e-4);
-static constexpr float TOLLERANCE_CLONE_SQUARED =
-    TOLLERANCE_CLONE * TOLLERANCE_CLONE;
-
-std::vector<std::string> splitta_riga(const std::string &riga) {
-  std::istringstream iss(riga);
-  std::vector<std::string> slices;
-  while (!iss.eof()) {
-    iss >> slices.emplace_back();
-  }
-  return slices;
-}
-
-float squared_distance(const Vector3d &a, const Vector3d &b) {
-  float distance = std::pow(a.x() - b.x(), 2.f);
-  distance += std::pow(a.y() - b.y(), 2.f);
-  distance += std::pow(a.z() - b.z(), 2.f);
-  return distance;
-}
-} // namespace
-
 std::vector<Vector3d> importAnimalStl(const std::string &animalName) {
   std::vector<Vector3d> imported_vertices;
-
-  auto filename = getAnimalStlPath(animalName);
-
-  std::ifstream f(filename);
-  if (!f.is_open())
-    throw std::runtime_error{filename.string() + " is an invalid filename"};
-
-  while (!f.eof()) {
-    std::string line;
-    std::getline(f, line);
-    auto slices = splitta_riga(line);
-    if ((!slices.empty()) && (slices.front() == "vertex")) {
-      if (slices.size() != 4) {
-        throw std::runtime_error{"Invalid line inside stl file"};
-      }
-      Vector3d maybe_new_vertex =
-          Vector3d{static_cast<float>(atof(slices[1].c_str())),
-                   static_cast<float>(atof(slices[2].c_str())),
-                   static_cast<float>(atof(slices[3].c_str()))};
-
-      auto vertices_clone_it =
-          std::find_if(imported_vertices.begin(), imported_vertices.end(),
-                       [&maybe_new_vertex](const Vector3d &v) {
-                         return squared_distance(maybe_new_vertex, v) <=
-                                TOLLERANCE_CLONE_SQUARED;
-                       });
-      if (vertices_clone_it == imported_vertices.end()) {
-        imported_vertices.push_back(maybe_new_vertex);
-      }
-    }
-  }
+  importStl(getAnimalStlPath(animalName),
+            [&imported_vertices](const float x, const float y, const float z) {
+              imported_vertices.emplace_back(x, y, z);
+            });
   return imported_vertices;
 }
 
@@ -9,6 +9,8 @@
 
 #include <QuickHull/FastQuickHull.h>
 
+#include "StlImporter.h"
+
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -42,7 +44,7 @@ void logConvexhull(const std::vector<qh::FacetIncidences> &facets_incidences,
                    const std::string &fileName);
 
 /** @brief Import an .STL file (https://en.wikipedia.org/wiki/STL_(file_format)
- * as a point cloud of vertices.
+ * as a point cloud of vertices. See also importStl.
  */
 std::vector<Vector3d> importAnimalStl(const std::string &animalName);
 